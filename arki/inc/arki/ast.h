@@ -22,6 +22,10 @@
  * @AST_SRR:    This node is a 'SRR' instruction
  * @AST_SRW:    This node is a 'SRW' instruction
  * @AST_OR:     This node is a 'OR' instruction
+ * @AST_ADD:    This node is a 'ADD' instruction
+ * @AST_SUB:    This node is a 'SUB' instruction
+ * @AST_AND:    This node is a 'AND' instruction
+ * @AST_XOR:    This node is a 'XOR' instruction
  * @AST_LITR:   This node is a 'LITR' instruction
  * @AST_STB:    This node is a 'STB' instruction
  * @AST_STW:    This node is a 'STW' instruction
@@ -32,9 +36,20 @@
  * @AST_LDL:    This node is a 'LDL' instruction
  * @AST_LDQ:    This node is a 'LDQ' instruction
  * @AST_BRANCH: This node is a 'B'   instruction
+ * @AST_BEQ:    This node is a 'BEQ' instruction
+ * @AST_BNE:    This node is a 'BNE' instruction
+ * @AST_BLT:    This node is a 'BLT' instruction
+ * @AST_BGE:    This node is a 'BGE' instruction
+ * @AST_BLTU:   This node is a 'BLTU' instruction
+ * @AST_BGEU:   This node is a 'BGEU' instruction
  * @AST_BYTE:   This node is a '.byte' directive
+ * @AST_WORD:   This node is a '.word' directive
+ * @AST_QUAD:   This node is a '.quad' directive
  * @AST_SKIP:   This node is a '.skip' directive
+ * @AST_INCBIN: This node is a '.incbin' directive
+ * @AST_ALIGN:  This node is a '.align' or '.balign' directive
  * @AST_NUMBER: This node is a number
+ * @AST_DATA:   This node is a run of raw bytes
  * @AST_REG:    This node is a register
  * @AST_LABEL:  This node is a register
  */
@@ -45,6 +60,10 @@ typedef enum {
     AST_SRR,
     AST_SRW,
     AST_OR,
+    AST_ADD,
+    AST_SUB,
+    AST_AND,
+    AST_XOR,
     AST_LITR,
     AST_STB,
     AST_STW,
@@ -55,9 +74,20 @@ typedef enum {
     AST_LDL,
     AST_LDQ,
     AST_BRANCH,
+    AST_BEQ,
+    AST_BNE,
+    AST_BLT,
+    AST_BGE,
+    AST_BLTU,
+    AST_BGEU,
     AST_BYTE,
+    AST_WORD,
+    AST_QUAD,
     AST_SKIP,
+    AST_INCBIN,
+    AST_ALIGN,
     AST_NUMBER,
+    AST_DATA,
     AST_REG,
     AST_LABEL,
 } ast_type_t;
@@ -69,12 +99,16 @@ typedef enum {
  * @left:   Left-hand leaf
  * @right:  Right-hand leaf
  * @symbol: Symbol associated with node
+ * @name:   Name of symbol referenced by node
+ * @data:   Bytes of an AST_DATA node, 'v' holds the length
  */
 struct ast_node {
     ast_type_t type;
     struct ast_node *left;
     struct ast_node *right;
     struct symbol *symbol;
+    const char *name;
+    const uint8_t *data;
     union {
         ssize_t v;
         reg_t reg;
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#ifndef ARKI_CACHE_H
+#define ARKI_CACHE_H 1
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "arki/sha256.h"
+
+/* Length of a cache key in hex digits */
+#define CACHE_KEY_LEN (SHA256_DIGEST_SIZE * 2)
+
+/* Default cache size limit */
+#define CACHE_DEFAULT_MAX (256UL * 1024 * 1024)
+
+/*
+ * Represents the build cache
+ *
+ * Entries are named after the hash of everything that goes
+ * into an output and are evicted least recently used first
+ * once the cache outgrows its limit. A hit touches the entry
+ * to mark it as used.
+ *
+ * @dir:      Cache directory
+ * @size_max: Size limit in bytes
+ * @hits:     Outputs found in the cache
+ * @misses:   Outputs that had to be assembled
+ * @stores:   Outputs written to the cache
+ * @evicted:  Entries evicted
+ * @lock:     Protects statistics
+ */
+struct arki_cache {
+    const char *dir;
+    size_t size_max;
+    size_t hits;
+    size_t misses;
+    size_t stores;
+    size_t evicted;
+    pthread_mutex_t lock;
+};
+
+/*
+ * Represents one output of an assembled file, an input has
+ * a cache entry per output
+ *
+ * @ext:  Output extension (e.g., ".bin")
+ * @path: Path of output
+ */
+struct cache_item {
+    const char *ext;
+    const char *path;
+};
+
+/*
+ * Initialize the build cache, creating its directory if
+ * needed
+ *
+ * @cache:    Cache to initialize
+ * @dir:      Cache directory
+ * @size_max: Size limit in bytes
+ *
+ * Returns zero on success
+ */
+int cache_init(struct arki_cache *cache, const char *dir, size_t size_max);
+
+/*
+ * Compute the cache key of an input file
+ *
+ * @path: Path of input file
+ * @salt: Tool version and options the output depends on
+ * @res:  NUL terminated key is written here
+ *
+ * Returns zero on success, one if the output also depends
+ * on files pulled in with '.incbin', which the key cannot
+ * cover, and less than zero on failure
+ */
+int cache_key(const char *path, const char *salt, char res[CACHE_KEY_LEN + 1]);
+
+/*
+ * Copy cached outputs out of the cache, it is only a hit
+ * if every output is cached
+ *
+ * @cache: Build cache
+ * @key:   Cache key
+ * @items: Outputs to fetch
+ * @count: Number of outputs
+ *
+ * Returns zero on a hit, one on a miss and less than zero
+ * on failure
+ */
+int cache_fetch(struct arki_cache *cache, const char *key,
+    const struct cache_item *items, size_t count);
+
+/*
+ * Copy freshly produced outputs into the cache
+ *
+ * @cache: Build cache
+ * @key:   Cache key
+ * @items: Outputs to copy in
+ * @count: Number of outputs
+ *
+ * Returns zero on success
+ */
+int cache_store(struct arki_cache *cache, const char *key,
+    const struct cache_item *items, size_t count);
+
+/*
+ * Evict least recently used entries until the cache is
+ * within its size limit
+ *
+ * @cache: Build cache
+ */
+void cache_evict(struct arki_cache *cache);
+
+/*
+ * Dump build cache statistics
+ *
+ * @cache: Build cache
+ */
+void cache_dump_stats(struct arki_cache *cache);
+
+#endif  /* !ARKI_CACHE_H */
@@ -21,4 +21,26 @@
  */
 int cg_resolve_node(struct arki_state *state, struct ast_node *root);
 
+/*
+ * Widen the forward-referencing movs of the first sizing
+ * pass whose label turned out not to fit a short move
+ *
+ * @state: Assembler state machine
+ *
+ * Returns zero on success
+ */
+int cg_settle_movs(struct arki_state *state);
+
+/*
+ * Patch every fixup recorded during a single-pass run
+ * into the output image
+ *
+ * @state: Assembler state machine
+ *
+ * Returns zero on success, one if a fixup does not fit the
+ * layout it was emitted with and a full two-pass assembly
+ * is needed instead
+ */
+int cg_apply_fixups(struct arki_state *state);
+
 #endif  /* !ARKI_CODEGEN_H */
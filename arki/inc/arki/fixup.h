@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#ifndef ARKI_FIXUP_H
+#define ARKI_FIXUP_H 1
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Represents valid fixup types
+ *
+ * @FIXUP_IMM16: 16-bit short move immediate holding a label
+ * @FIXUP_SIZE8: Byte holding the output size ('@')
+ * @FIXUP_IMM48: 48-bit wide move immediate holding a label
+ * @FIXUP_REL16: 16-bit branch displacement to a label
+ * @FIXUP_MOVSZ: Forward-referencing mov sized short on the first
+ *               sizing pass, @off is its index in the mov sizing
+ *               vector
+ */
+typedef enum {
+    FIXUP_IMM16,
+    FIXUP_SIZE8,
+    FIXUP_IMM48,
+    FIXUP_REL16,
+    FIXUP_MOVSZ
+} fixup_type_t;
+
+/*
+ * Represents a spot in the output image that must be
+ * patched once its value is known
+ *
+ * @type:     Fixup type
+ * @name:     Name of referenced symbol (if any)
+ * @off:      Offset into the output image
+ * @addend:   Added to the symbol address
+ * @line_num: Line the reference was made on
+ */
+struct fixup {
+    fixup_type_t type;
+    char *name;
+    size_t off;
+    ssize_t addend;
+    size_t line_num;
+};
+
+/*
+ * Represents the fixup table
+ *
+ * @fixups: Fixups in order of creation
+ * @count:  Number of fixups
+ * @cap:    Capacity of fixup vector
+ */
+struct fixup_table {
+    struct fixup *fixups;
+    size_t count;
+    size_t cap;
+};
+
+/*
+ * Initialize a fixup table
+ *
+ * @table: Table to initialize
+ *
+ * Returns zero on success
+ */
+int fixup_table_init(struct fixup_table *table);
+
+/*
+ * Record a new fixup
+ *
+ * @table:    Table to add fixup to
+ * @type:     Fixup type
+ * @name:     Name of referenced symbol, NULL if none
+ * @off:      Offset into the output image
+ * @addend:   Added to the symbol address
+ * @line_num: Line the reference was made on
+ *
+ * Returns zero on success
+ */
+int fixup_table_add(
+    struct fixup_table *table, fixup_type_t type,
+    const char *name, size_t off, ssize_t addend,
+    size_t line_num
+);
+
+/*
+ * Destroy a fixup table
+ *
+ * @table: Table to destroy
+ */
+void fixup_table_destroy(struct fixup_table *table);
+
+#endif  /* !ARKI_FIXUP_H */
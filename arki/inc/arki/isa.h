@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+/*
+ * Machine-readable description of the Y-64 instruction set,
+ * shared by the assembler and the emulator so that neither
+ * keeps its own copy of opcodes or layouts.
+ *
+ * See spec/Y-64.0.md for the prose version.
+ */
+
+#ifndef ARKI_ISA_H
+#define ARKI_ISA_H 1
+
+#include <stdint.h>
+
+/* Number of opcodes an instruction can encode */
+#define ISA_OPCODE_MAX 256
+
+/*
+ * Instruction formats, every instruction is little-endian
+ * with the opcode in its first byte
+ *
+ * @ISA_FMT_NONE: Opcode not defined
+ * @ISA_FMT_A:    Opcode only
+ * @ISA_FMT_B:    Rd [15:8], Rs [23:16]
+ * @ISA_FMT_C:    Rd [15:8], Imm [63:16]
+ * @ISA_FMT_D:    Rd [15:8], Imm [31:16]
+ * @ISA_FMT_E:    Rd [15:8]
+ * @ISA_FMT_F:    Rd [15:8], Rs [23:16], Disp [39:24]
+ */
+typedef enum {
+    ISA_FMT_NONE,
+    ISA_FMT_A,
+    ISA_FMT_B,
+    ISA_FMT_C,
+    ISA_FMT_D,
+    ISA_FMT_E,
+    ISA_FMT_F
+} isa_fmt_t;
+
+/* Instruction length in bytes of each format */
+#define ISA_LEN_A 1
+#define ISA_LEN_B 3
+#define ISA_LEN_C 8
+#define ISA_LEN_D 4
+#define ISA_LEN_E 2
+#define ISA_LEN_F 5
+
+/* Immediate width in bits of each format */
+#define ISA_IMM_BITS_A 0
+#define ISA_IMM_BITS_B 0
+#define ISA_IMM_BITS_C 48
+#define ISA_IMM_BITS_D 16
+#define ISA_IMM_BITS_E 0
+#define ISA_IMM_BITS_F 0
+
+/*
+ * Width in bits of a branch displacement, which is signed
+ * and relative to the address of the branch itself
+ */
+#define ISA_DISP_BITS 16
+
+/* Operand field offsets in bits */
+#define ISA_RD_SHIFT  8
+#define ISA_RS_SHIFT  16
+#define ISA_IMM_SHIFT 16
+#define ISA_DISP_SHIFT 24
+
+/* Instruction flags */
+#define ISA_F_JUMP  (1 << 0)    /* Sets PC itself, which is not advanced */
+#define ISA_F_HALT  (1 << 1)    /* Halts the processor */
+
+/*
+ * Every defined instruction, expanded once per use with
+ * X(name, opcode, format, flags, description) so that
+ * tables indexed by opcode can be generated at compile
+ * time. Keep sorted by opcode.
+ */
+#define ISA_INSTS(X)                                                \
+    X(NOP,   0x00, A, 0,           "No-operation")                  \
+    X(IMOV,  0x01, C, 0,           "Move wide IMM")                 \
+    X(MOV,   0x02, B, 0,           "Register move")                 \
+    X(IMOVS, 0x03, D, 0,           "Move short IMM")                \
+    X(IADD,  0x05, D, 0,           "IMM register ADD")              \
+    X(ADD,   0x06, B, 0,           "Register ADD")                  \
+    X(ISUB,  0x07, D, 0,           "IMM register SUB")              \
+    X(SUB,   0x08, B, 0,           "Register SUB")                  \
+    X(HLT,   0x0D, A, ISA_F_HALT,  "Halt")                          \
+    X(SRR,   0x0E, A, 0,           "Special register read")         \
+    X(SRW,   0x0F, A, 0,           "Special register write")        \
+    X(IOR,   0x10, D, 0,           "IMM bitwise OR")                \
+    X(OR,    0x11, B, 0,           "Register bitwise OR")           \
+    X(AND,   0x12, B, 0,           "Register bitwise AND")          \
+    X(XOR,   0x13, B, 0,           "Register bitwise XOR")          \
+    X(LITR,  0x14, E, 0,           "Load ITR")                      \
+    X(STB,   0x15, B, 0,           "Store byte")                    \
+    X(STW,   0x16, B, 0,           "Store word")                    \
+    X(STL,   0x17, B, 0,           "Store dword")                   \
+    X(STQ,   0x18, B, 0,           "Store qword")                   \
+    X(LDB,   0x19, B, 0,           "Load byte")                     \
+    X(LDW,   0x1A, B, 0,           "Load word")                     \
+    X(LDL,   0x1B, B, 0,           "Load dword")                    \
+    X(LDQ,   0x1C, B, 0,           "Load qword")                    \
+    X(B,     0x1D, E, ISA_F_JUMP,  "Indirect branch")               \
+    X(BEQ,   0x1E, F, ISA_F_JUMP,  "Branch if equal")               \
+    X(BNE,   0x1F, F, ISA_F_JUMP,  "Branch if not equal")           \
+    X(BLT,   0x20, F, ISA_F_JUMP,  "Branch if less (signed)")       \
+    X(BGE,   0x21, F, ISA_F_JUMP,  "Branch if not less (signed)")   \
+    X(BLTU,  0x22, F, ISA_F_JUMP,  "Branch if less (unsigned)")     \
+    X(BGEU,  0x23, F, ISA_F_JUMP,  "Branch if not less (unsigned)")
+
+/* Opcodes as ISA_OPC_<name> */
+#define ISA_OPC_ENUM(name, opcode, fmt, flags, desc) \
+    ISA_OPC_##name = (opcode),
+
+typedef enum {
+    ISA_INSTS(ISA_OPC_ENUM)
+} isa_opc_t;
+
+#undef ISA_OPC_ENUM
+
+/*
+ * Represents an entry of an opcode table
+ *
+ * @name:  Instruction name
+ * @fmt:   Instruction format
+ * @len:   Length in bytes
+ * @flags: ISA_F_* flags
+ */
+struct isa_inst {
+    const char *name;
+    isa_fmt_t fmt;
+    uint8_t len;
+    uint8_t flags;
+};
+
+/*
+ * Initializer of an opcode table entry, to be used as
+ *
+ *     const struct isa_inst tab[ISA_OPCODE_MAX] = {
+ *         ISA_INSTS(ISA_INST_ENTRY)
+ *     };
+ *
+ * opcodes left out stay zeroed with ISA_FMT_NONE.
+ */
+#define ISA_INST_ENTRY(name, opcode, fmt, flags, desc) \
+    [(opcode)] = { #name, ISA_FMT_##fmt, ISA_LEN_##fmt, (flags) },
+
+/*
+ * Encode an instruction, fields the format of the opcode
+ * has no room for are dropped
+ *
+ * @fmt:    Format of instruction
+ * @opcode: Opcode of instruction
+ * @rd:     Destination register
+ * @rs:     Source register
+ * @imm:    Immediate, or displacement of a branch
+ */
+static inline uint64_t
+isa_encode(isa_fmt_t fmt, uint8_t opcode, uint8_t rd, uint8_t rs, uint64_t imm)
+{
+    uint64_t raw = opcode;
+
+    switch (fmt) {
+    case ISA_FMT_B:
+        raw |= (uint64_t)rd << ISA_RD_SHIFT;
+        raw |= (uint64_t)rs << ISA_RS_SHIFT;
+        break;
+    case ISA_FMT_C:
+        raw |= (uint64_t)rd << ISA_RD_SHIFT;
+        raw |= (imm & ((1ULL << ISA_IMM_BITS_C) - 1)) << ISA_IMM_SHIFT;
+        break;
+    case ISA_FMT_D:
+        raw |= (uint64_t)rd << ISA_RD_SHIFT;
+        raw |= (imm & ((1ULL << ISA_IMM_BITS_D) - 1)) << ISA_IMM_SHIFT;
+        break;
+    case ISA_FMT_E:
+        raw |= (uint64_t)rd << ISA_RD_SHIFT;
+        break;
+    case ISA_FMT_F:
+        raw |= (uint64_t)rd << ISA_RD_SHIFT;
+        raw |= (uint64_t)rs << ISA_RS_SHIFT;
+        raw |= (imm & ((1ULL << ISA_DISP_BITS) - 1)) << ISA_DISP_SHIFT;
+        break;
+    default:
+        break;
+    }
+
+    return raw;
+}
+
+/* Extract the fields of a raw instruction */
+#define ISA_RD(raw)        (((raw) >> ISA_RD_SHIFT) & 0xFF)
+#define ISA_RS(raw)        (((raw) >> ISA_RS_SHIFT) & 0xFF)
+#define ISA_IMM(raw, bits) (((raw) >> ISA_IMM_SHIFT) & ((1ULL << (bits)) - 1))
+#define ISA_DISP(raw)      ((int16_t)(((raw) >> ISA_DISP_SHIFT) & 0xFFFF))
+
+#endif  /* !ARKI_ISA_H */
@@ -6,6 +6,8 @@
 #ifndef ARKI_LEXER_H
 #define ARKI_LEXER_H 1
 
+#include <stdint.h>
+#include <stdbool.h>
 #include "arki/token.h"
 #include "arki/state.h"
 
@@ -19,4 +21,31 @@
  */
 int lexer_scan(struct arki_state *state, struct token *res);
 
+/*
+ * Scan a comma separated list of plain numbers straight
+ * out of the input, without going through tokens. Stops at
+ * the first element that is not a plain number, at the end
+ * of the list or once 'cap' numbers have been scanned, and
+ * leaves the rest to lexer_scan().
+ *
+ * @state: Assembler state machine
+ * @width: Bytes per number
+ * @buf:   Numbers are written here, little-endian
+ * @cap:   Most numbers to scan
+ * @more:  Set if an element is next rather than the end
+ *
+ * Returns the number of numbers scanned
+ */
+size_t lexer_scan_data(struct arki_state *state, size_t width, uint8_t *buf, size_t cap,
+    bool *more);
+
+/*
+ * Check that every keyword token has exactly one keyword
+ * table entry and that each entry sits in the slot its
+ * name hashes to, mismatches are printed
+ *
+ * Returns zero if the keyword table is sound
+ */
+int lexer_kw_check(void);
+
 #endif  /* !ARKI_LEXER_H */
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#ifndef ARKI_LIBARKI_H
+#define ARKI_LIBARKI_H 1
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * libarki assembles Y-64 sources in memory, nothing is
+ * read from or written to disk unless asked to. Each call
+ * has its own state so several threads may assemble at
+ * once.
+ */
+
+#define ARKI_VERSION "0.0.2"
+
+struct arki_prof;
+
+/*
+ * Assembly options, a zeroed structure gives a flat image
+ * in as many passes as needed
+ *
+ * @one_pass: Try a single pass first, backpatching fixups
+ * @obj:      Produce a relocatable object instead of an image
+ * @map:      Produce a symbol map (see arki/map.h)
+ * @listing:  Produce a listing
+ * @stream:   Write the image to 'stream_fd' as it is made
+ *            instead of returning it, memory use then depends
+ *            on the number of symbols rather than image size
+ * @stream_fd: File to stream the image to, truncated first
+ * @prof:     Produce a timing and memory report (see arki/prof.h)
+ */
+struct arki_options {
+    bool one_pass;
+    bool obj;
+    bool map;
+    bool listing;
+    bool stream;
+    int stream_fd;
+    bool prof;
+};
+
+/*
+ * Represents a label of an assembled source
+ *
+ * @name: Name of label
+ * @addr: Address of label, origin included
+ */
+struct arki_sym {
+    const char *name;
+    uint64_t addr;
+};
+
+/*
+ * Represents the result of an assembly, buffers are NULL
+ * if not produced and are released with arki_result_free()
+ *
+ * @image:       Flat image or relocatable object, NULL if streamed
+ * @image_len:   Length of image
+ * @syms:        Labels in order of definition
+ * @sym_count:   Number of labels
+ * @map:         Symbol map if requested
+ * @map_len:     Length of symbol map
+ * @listing:     Listing if requested, NUL terminated
+ * @listing_len: Length of listing
+ * @diag:        Diagnostics, NUL terminated
+ * @diag_len:    Length of diagnostics
+ * @prof:        Timing and memory report if requested
+ */
+struct arki_result {
+    uint8_t *image;
+    size_t image_len;
+    struct arki_sym *syms;
+    size_t sym_count;
+    uint8_t *map;
+    size_t map_len;
+    char *listing;
+    size_t listing_len;
+    char *diag;
+    size_t diag_len;
+    struct arki_prof *prof;
+};
+
+/*
+ * Assemble a source buffer
+ *
+ * @src:  Source buffer, need not be NUL terminated
+ * @len:  Length of source buffer
+ * @opts: Assembly options, NULL for defaults
+ * @res:  Result is written here
+ *
+ * Returns zero on success, on failure 'res' still holds
+ * the diagnostics
+ */
+int arki_assemble(const char *src, size_t len, const struct arki_options *opts,
+    struct arki_result *res);
+
+/*
+ * Assemble a source file
+ *
+ * @path: Path of source file
+ * @opts: Assembly options, NULL for defaults
+ * @res:  Result is written here
+ *
+ * Returns zero on success, on failure 'res' still holds
+ * the diagnostics
+ */
+int arki_assemble_file(const char *path, const struct arki_options *opts,
+    struct arki_result *res);
+
+/*
+ * Release the buffers of a result
+ *
+ * @res: Result to release
+ */
+void arki_result_free(struct arki_result *res);
+
+#endif  /* !ARKI_LIBARKI_H */
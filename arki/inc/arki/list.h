@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#ifndef ARKI_LIST_H
+#define ARKI_LIST_H 1
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "arki/token.h"
+
+/*
+ * Represents a source line in the listing
+ *
+ * @addr:     Address of line, origin included
+ * @vpc:      Offset of line in the output image
+ * @len:      Number of bytes the line emitted
+ * @pos:      Offset of line in the input buffer
+ * @line_num: Line number
+ */
+struct list_line {
+    uintptr_t addr;
+    size_t vpc;
+    size_t len;
+    size_t pos;
+    size_t line_num;
+};
+
+/*
+ * Represents the listing of an assembled file, lines are
+ * collected on the emitting pass and written out once the
+ * image is final.
+ *
+ * @enabled: Set if a listing is being collected
+ * @lines:   Lines with labels or code
+ * @count:   Number of lines
+ * @cap:     Capacity of line vector
+ */
+struct arki_listing {
+    bool enabled;
+    struct list_line *lines;
+    size_t count;
+    size_t cap;
+};
+
+struct arki_state;
+
+/*
+ * Note the start of a statement for the listing
+ *
+ * @state: Assembler state
+ * @type:  Type of the first token of the statement
+ *
+ * Returns zero on success
+ */
+int list_stmt(struct arki_state *state, tt_t type);
+
+/*
+ * Close the last line of the listing at the end of a pass
+ *
+ * @state: Assembler state
+ */
+void list_end(struct arki_state *state);
+
+/*
+ * Write the listing out
+ *
+ * @state: Assembler state
+ * @fp:    File to write to
+ *
+ * Returns zero on success
+ */
+int list_write(struct arki_state *state, FILE *fp);
+
+/*
+ * Release a listing
+ *
+ * @list: Listing to release
+ */
+void list_destroy(struct arki_listing *list);
+
+#endif  /* !ARKI_LIST_H */
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#ifndef ARKI_MAP_H
+#define ARKI_MAP_H 1
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Symbol map file layout, all fields are little endian and
+ * naturally aligned so the file can be mapped and searched
+ * in place:
+ *
+ *  +----------------------+ 0
+ *  | struct map_hdr       |
+ *  +----------------------+ sizeof(struct map_hdr)
+ *  | struct map_sym[]     |  sorted by address
+ *  +----------------------+
+ *  | NUL terminated names |
+ *  +----------------------+
+ */
+
+/* Map file magic and version */
+#define MAP_MAGIC   "Y64M"
+#define MAP_VERSION 1
+
+/*
+ * Map file header
+ *
+ * @magic:     Must be MAP_MAGIC
+ * @version:   Must be MAP_VERSION
+ * @sym_count: Number of symbols
+ * @str_size:  Size of string table
+ */
+struct map_hdr {
+    char magic[4];
+    uint32_t version;
+    uint32_t sym_count;
+    uint32_t str_size;
+};
+
+/*
+ * Map file symbol
+ *
+ * @addr: Address of symbol, origin included
+ * @size: Bytes up to the next symbol or the end of the image
+ * @name: String table offset of symbol name
+ */
+struct map_sym {
+    uint64_t addr;
+    uint32_t size;
+    uint32_t name;
+};
+
+struct arki_state;
+
+/*
+ * Encode the symbols of an assembled image as a map
+ *
+ * @state: Assembler state
+ * @res:   Allocated map is written here
+ * @len:   Length of map is written here
+ *
+ * Returns zero on success
+ */
+int map_encode(struct arki_state *state, uint8_t **res, size_t *len);
+
+#endif  /* !ARKI_MAP_H */
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#ifndef ARKI_OBJ_H
+#define ARKI_OBJ_H 1
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Relocatable object file layout, all fields are little
+ * endian and naturally aligned:
+ *
+ *  +----------------------+ 0
+ *  | struct obj_hdr       |
+ *  +----------------------+ sect_off
+ *  | struct obj_sect[]    |
+ *  +----------------------+ sym_off
+ *  | struct obj_sym[]     |
+ *  +----------------------+ reloc_off
+ *  | struct obj_reloc[]   |
+ *  +----------------------+ str_off
+ *  | NUL terminated names |
+ *  +----------------------+
+ *  | section data         |
+ *  +----------------------+
+ */
+
+/* Object file magic and version */
+#define OBJ_MAGIC   "Y64O"
+#define OBJ_VERSION 1
+
+/* Default object output filename */
+#define DEFAULT_OBJ_OUT "y64.o"
+
+/* Header flags */
+#define OBJ_F_ORIGIN (1 << 0)   /* Object requests a load address */
+
+/* Section index of undefined symbols */
+#define OBJ_SECT_UNDEF 0xFFFFFFFF
+
+/* Symbol index of relocations without a symbol */
+#define OBJ_SYM_NONE 0xFFFFFFFF
+
+/*
+ * Represents valid relocation types
+ *
+ * @OBJ_RELOC_IMM48: 48-bit wide move immediate, symbol address
+ * @OBJ_RELOC_SIZE8: Byte holding the linked image size ('@')
+ */
+typedef enum {
+    OBJ_RELOC_IMM48,
+    OBJ_RELOC_SIZE8
+} obj_reloc_t;
+
+/*
+ * Object file header
+ *
+ * @magic:       Must be OBJ_MAGIC
+ * @version:     Must be OBJ_VERSION
+ * @flags:       Header flags
+ * @origin:      Load address if OBJ_F_ORIGIN is set
+ * @sect_count:  Number of sections
+ * @sect_off:    File offset of section table
+ * @sym_count:   Number of symbols
+ * @sym_off:     File offset of symbol table
+ * @reloc_count: Number of relocations
+ * @reloc_off:   File offset of relocation table
+ * @str_size:    Size of string table
+ * @str_off:     File offset of string table
+ */
+struct obj_hdr {
+    char magic[4];
+    uint16_t version;
+    uint16_t flags;
+    uint64_t origin;
+    uint32_t sect_count;
+    uint32_t sect_off;
+    uint32_t sym_count;
+    uint32_t sym_off;
+    uint32_t reloc_count;
+    uint32_t reloc_off;
+    uint32_t str_size;
+    uint32_t str_off;
+};
+
+/*
+ * Object section
+ *
+ * @name:  String table offset of section name
+ * @align: Section alignment (power-of-two)
+ * @off:   File offset of section data
+ * @size:  Size of section data
+ */
+struct obj_sect {
+    uint32_t name;
+    uint32_t align;
+    uint32_t off;
+    uint32_t size;
+};
+
+/*
+ * Object symbol
+ *
+ * @name:  String table offset of symbol name
+ * @sect:  Section index, OBJ_SECT_UNDEF if undefined
+ * @value: Offset of symbol within its section
+ */
+struct obj_sym {
+    uint32_t name;
+    uint32_t sect;
+    uint64_t value;
+};
+
+/*
+ * Object relocation
+ *
+ * @sect: Index of section being patched
+ * @sym:  Symbol index, OBJ_SYM_NONE if none
+ * @off:  Offset of patch within section
+ * @type: Relocation type (obj_reloc_t)
+ */
+struct obj_reloc {
+    uint32_t sect;
+    uint32_t sym;
+    uint32_t off;
+    uint32_t type;
+};
+
+struct arki_state;
+
+/*
+ * Encode the assembled image as a relocatable object
+ *
+ * @state: Assembler state
+ * @res:   Allocated object file is written here
+ * @len:   Length of object file is written here
+ *
+ * Returns zero on success
+ */
+int obj_encode(struct arki_state *state, uint8_t **res, size_t *len);
+
+#endif  /* !ARKI_OBJ_H */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#ifndef ARKI_PROF_H
+#define ARKI_PROF_H 1
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Passes kept apart, later ones are added to the last */
+#define ARKI_PROF_PASS_MAX 16
+
+/* Deepest nesting of timed phases */
+#define ARKI_PROF_DEPTH 8
+
+/*
+ * Phases of assembly that are timed, the time of a phase
+ * excludes the phases it calls into
+ *
+ * @ARKI_PROF_LEX:     Scanning tokens
+ * @ARKI_PROF_PARSE:   Parsing statements
+ * @ARKI_PROF_SYMBOL:  Looking up and defining symbols
+ * @ARKI_PROF_CODEGEN: Generating code
+ * @ARKI_PROF_IO:      Reading and writing files
+ */
+typedef enum {
+    ARKI_PROF_LEX,
+    ARKI_PROF_PARSE,
+    ARKI_PROF_SYMBOL,
+    ARKI_PROF_CODEGEN,
+    ARKI_PROF_IO,
+    ARKI_PROF_PHASES
+} arki_prof_phase_t;
+
+/*
+ * Represents the time spent in a phase
+ *
+ * @ns:    Wall time in nanoseconds
+ * @calls: Number of times the phase was entered
+ */
+struct arki_prof_stat {
+    uint64_t ns;
+    uint64_t calls;
+};
+
+/*
+ * Represents a single pass over the source
+ *
+ * @kind:   Kind of pass ("single", "size" or "emit")
+ * @ns:     Wall time of pass in nanoseconds
+ * @tokens: Number of tokens scanned
+ * @phases: Time spent in each phase
+ */
+struct arki_prof_pass {
+    const char *kind;
+    uint64_t ns;
+    size_t tokens;
+    struct arki_prof_stat phases[ARKI_PROF_PHASES];
+};
+
+/*
+ * Represents the timing and memory report of an assembly
+ *
+ * @enabled:     Set if timing is being collected
+ * @passes:      Passes made over the source
+ * @pass_count:  Number of passes made
+ * @io:          File I/O outside of the passes
+ * @total_ns:    Wall time of the whole assembly
+ * @symbols:     Number of symbols defined
+ * @ptrbox_peak: Highest number of live pointer box bytes
+ * @in_pass:     Set while a pass is being timed
+ * @depth:       Nesting of phases being timed
+ * @child_ns:    Time spent in phases called by each level
+ */
+struct arki_prof {
+    bool enabled;
+    struct arki_prof_pass passes[ARKI_PROF_PASS_MAX];
+    size_t pass_count;
+    struct arki_prof_stat io;
+    uint64_t total_ns;
+    size_t symbols;
+    size_t ptrbox_peak;
+    bool in_pass;
+    size_t depth;
+    uint64_t child_ns[ARKI_PROF_DEPTH];
+};
+
+/*
+ * Returns the pass being timed
+ *
+ * @prof: Report
+ */
+static inline struct arki_prof_pass *
+arki_prof_cur(struct arki_prof *prof)
+{
+    if (prof->pass_count >= ARKI_PROF_PASS_MAX) {
+        return &prof->passes[ARKI_PROF_PASS_MAX - 1];
+    }
+
+    return &prof->passes[prof->pass_count];
+}
+
+/*
+ * Returns a monotonic time in nanoseconds
+ */
+uint64_t arki_prof_now(void);
+
+/*
+ * Enter a phase, a no-op unless timing is enabled
+ *
+ * @prof: Report
+ *
+ * Returns the start time to hand to arki_prof_end()
+ */
+uint64_t arki_prof_begin(struct arki_prof *prof);
+
+/*
+ * Leave a phase entered with arki_prof_begin(), file I/O
+ * outside of a pass is charged to 'io' of the report
+ *
+ * @prof:  Report
+ * @phase: Phase being left
+ * @start: Start time of phase
+ */
+void arki_prof_end(struct arki_prof *prof, arki_prof_phase_t phase, uint64_t start);
+
+/*
+ * Start timing a pass over the source
+ *
+ * @prof: Report
+ * @kind: Kind of pass
+ *
+ * Returns the start time to hand to arki_prof_pass_end()
+ */
+uint64_t arki_prof_pass_begin(struct arki_prof *prof, const char *kind);
+
+/*
+ * Stop timing a pass over the source
+ *
+ * @prof:  Report
+ * @start: Start time of pass
+ */
+void arki_prof_pass_end(struct arki_prof *prof, uint64_t start);
+
+/*
+ * Write out a report
+ *
+ * @prof: Report
+ * @path: Path of the assembled source
+ * @fp:   File to write to
+ * @json: Write a single JSON object rather than text
+ *
+ * Returns zero on success
+ */
+int arki_prof_write(const struct arki_prof *prof, const char *path, FILE *fp, bool json);
+
+#endif  /* !ARKI_PROF_H */
@@ -10,28 +10,57 @@
 #include <stdint.h>
 #include <stddef.h>
 
+/* Default pointer box chunk size */
+#define PTRBOX_CHUNK_SIZE 65536
+
 /*
- * Represents a pointer box entry which stores a reference
- * to allocated memory
+ * Represents a chunk of pointer box memory that allocations
+ * are bumped out of
  *
- * @data: Allocated memory
+ * @data: Usable memory
+ * @size: Size of usable memory
+ * @used: Number of bytes handed out
  * @link: Queue link
  */
-struct ptrbox_entry {
-    void *data;
-    TAILQ_ENTRY(ptrbox_entry) link;
+struct ptrbox_chunk {
+    uint8_t *data;
+    size_t size;
+    size_t used;
+    TAILQ_ENTRY(ptrbox_chunk) link;
 };
 
 /*
- * A pointer box stores one or more references to allocated memory
- * so that it can be cleaned up in one sweep when usage is complete.
+ * A pointer box is an arena that hands out memory from chunks
+ * so that it can be cleaned up in one sweep when usage is
+ * complete, or rolled back to an earlier mark.
  *
- * @entries: Pointer box entries
- * @entry_count: Number of entries in pointer box
+ * @chunks: Chunks owned by the pointer box
+ * @cur: Chunk allocations are currently bumped out of
+ * @entry_count: Number of live allocations in pointer box
+ * @bytes_used: Number of live bytes in pointer box
+ * @bytes_peak: Highest number of live bytes seen
  */
 struct ptrbox {
-    TAILQ_HEAD(, ptrbox_entry) entries;
+    TAILQ_HEAD(, ptrbox_chunk) chunks;
+    struct ptrbox_chunk *cur;
+    size_t entry_count;
+    size_t bytes_used;
+    size_t bytes_peak;
+};
+
+/*
+ * Represents a point a pointer box may be rolled back to
+ *
+ * @chunk: Current chunk at time of marking
+ * @used: Bytes used within chunk at time of marking
+ * @entry_count: Live allocations at time of marking
+ * @bytes_used: Live bytes at time of marking
+ */
+struct ptrbox_mark {
+    struct ptrbox_chunk *chunk;
+    size_t used;
     size_t entry_count;
+    size_t bytes_used;
 };
 
 /*
@@ -55,6 +84,23 @@ void *ptrbox_alloc(struct ptrbox *ptrbox, size_t sz);
  */
 void *ptrbox_strdup(struct ptrbox *ptrbox, const char *s);
 
+/*
+ * Record the current allocation point of a pointer box
+ *
+ * @ptrbox: Pointer box to mark
+ * @res: Mark is written here
+ */
+void ptrbox_mark(struct ptrbox *ptrbox, struct ptrbox_mark *res);
+
+/*
+ * Roll a pointer box back to a mark, releasing everything
+ * allocated since. Chunks are kept around for reuse.
+ *
+ * @ptrbox: Pointer box to roll back
+ * @mark: Mark to roll back to
+ */
+void ptrbox_reset(struct ptrbox *ptrbox, const struct ptrbox_mark *mark);
+
 /*
  * Destroy a pointer box
  *
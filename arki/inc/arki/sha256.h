@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#ifndef ARKI_SHA256_H
+#define ARKI_SHA256_H 1
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Size of a SHA-256 digest in bytes */
+#define SHA256_DIGEST_SIZE 32
+
+/*
+ * Represents a SHA-256 hashing context
+ *
+ * @state: Intermediate hash state
+ * @count: Number of bytes hashed so far
+ * @buf:   Partial block
+ */
+struct sha256 {
+    uint32_t state[8];
+    uint64_t count;
+    uint8_t buf[64];
+};
+
+/*
+ * Initialize a SHA-256 context
+ *
+ * @ctx: Context to initialize
+ */
+void sha256_init(struct sha256 *ctx);
+
+/*
+ * Hash more bytes into a SHA-256 context
+ *
+ * @ctx: Context to update
+ * @p:   Bytes to hash
+ * @n:   Number of bytes to hash
+ */
+void sha256_update(struct sha256 *ctx, const void *p, size_t n);
+
+/*
+ * Finish a SHA-256 context and get its digest
+ *
+ * @ctx: Context to finish
+ * @res: Digest is written here
+ */
+void sha256_final(struct sha256 *ctx, uint8_t res[SHA256_DIGEST_SIZE]);
+
+#endif  /* !ARKI_SHA256_H */
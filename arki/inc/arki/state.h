@@ -8,10 +8,14 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include <unistd.h>
 #include "arki/ptrbox.h"
 #include "arki/token.h"
 #include "arki/symbol.h"
+#include "arki/fixup.h"
+#include "arki/list.h"
+#include "arki/prof.h"
 
 /* Default output filename */
 #define DEFAULT_OUT "y64.bin"
@@ -19,9 +23,23 @@
 /*
  * Represents the assembler state
  *
- * @in_fd:      Input file descriptor
- * @out_fd:     Output file descriptor
+ * @in_path:    Path of input file, NULL if assembling a buffer
+ * @in_buf:     Input source buffer
+ * @in_len:     Length of input source buffer
+ * @in_pos:     Lexer cursor into input source buffer
+ * @in_mapped:  Set if the input buffer is a file mapping
+ * @in_owned:   Set if the input buffer is ours to free
+ * @in_dropped: Input released so far this pass when streaming
+ * @out_buf:    Output image buffer
+ * @out_cap:    Capacity of output image buffer
+ * @out_len:    Number of bytes of output image in use
+ * @out_fd:     Output file when streaming, otherwise -1
+ * @out_base:   Image offset of 'out_buf' when streaming
+ * @out_pend:   Bytes of 'out_buf' not yet written when streaming
  * @symtab:     Global symbol table
+ * @fixups:     Forward references awaiting a value (single-pass),
+ *              forward-referencing movs (first sizing pass), or
+ *              relocations (object output)
  * @ptrbox:     Global pointer box
  * @last_tok:   Last token
  * @line_num:   Current line number
@@ -29,12 +47,41 @@
  * @origin:     Program origin address
  * @out_size:   Output binary size
  * @vpc:        Virtual program counter
+ * @end_addr:   Address past the end of the image, origin included
  * @putback:    Putback buffer for lexer
+ * @one_pass:   Assemble in a single pass, backpatching fixups
+ * @mov_wide:   Per label-dependent mov, set if it is sized wide
+ * @mov_cap:    Capacity of mov sizing vector
+ * @mov_idx:    Label-dependent movs seen this pass
+ * @label_idx:  Labels seen this pass
+ * @relax_pass: Number of sizing passes made
+ * @unsettled:  Set if the layout may still change
+ * @listing:    Listing collected on the emitting pass
+ * @obj:        Write a relocatable object instead of a flat image
+ * @obj_origin: Load address requested by '.origin' in an object
+ * @obj_origin_set: Set if 'obj_origin' is valid
+ * @obj_align:  Largest alignment requested in an object
+ * @prof:       Timing and memory report
+ * @diag:       Diagnostics, NUL terminated
+ * @diag_len:   Length of diagnostics
+ * @diag_cap:   Capacity of diagnostics buffer
  */
 struct arki_state {
-    int in_fd;
+    const char *in_path;
+    const char *in_buf;
+    size_t in_len;
+    size_t in_pos;
+    bool in_mapped;
+    bool in_owned;
+    size_t in_dropped;
+    uint8_t *out_buf;
+    size_t out_cap;
+    size_t out_len;
     int out_fd;
+    size_t out_base;
+    size_t out_pend;
     struct symbol_table symtab;
+    struct fixup_table fixups;
     struct ptrbox ptrbox;
     struct token last_tok;
     size_t line_num;
@@ -42,7 +89,24 @@ struct arki_state {
     uintptr_t origin;
     size_t out_size;
     uintptr_t vpc;
+    uintptr_t end_addr;
     char putback;
+    bool one_pass;
+    uint8_t *mov_wide;
+    size_t mov_cap;
+    size_t mov_idx;
+    size_t label_idx;
+    size_t relax_pass;
+    bool unsettled;
+    struct arki_listing listing;
+    bool obj;
+    uintptr_t obj_origin;
+    bool obj_origin_set;
+    size_t obj_align;
+    struct arki_prof prof;
+    char *diag;
+    size_t diag_len;
+    size_t diag_cap;
 };
 
 /*
@@ -57,19 +121,141 @@ arki_get_vpc(struct arki_state *state)
     return state->origin + state->vpc;
 }
 
+/*
+ * Returns true if the current pass writes to the
+ * output image
+ *
+ * @state: Assembler state
+ */
+static inline bool
+arki_emitting(struct arki_state *state)
+{
+    return state->pass_count == 1 || state->one_pass;
+}
+
+/*
+ * Returns true if the output image is streamed to a file
+ * instead of being kept in memory
+ *
+ * @state: Assembler state
+ */
+static inline bool
+arki_streaming(struct arki_state *state)
+{
+    return state->out_fd >= 0;
+}
+
+/*
+ * Write bytes into the output image, growing it if needed
+ *
+ * @state: Assembler state
+ * @off:   Offset into the image
+ * @buf:   Bytes to write
+ * @n:     Number of bytes to write
+ *
+ * Returns zero on success
+ */
+int arki_image_write(struct arki_state *state, size_t off, const void *buf, size_t n);
+
+/*
+ * Fill a run of the output image with a single byte
+ *
+ * @state: Assembler state
+ * @off:   Offset into the image
+ * @byte:  Byte to fill with
+ * @n:     Number of bytes to fill
+ *
+ * Returns zero on success
+ */
+int arki_image_fill(struct arki_state *state, size_t off, uint8_t byte, size_t n);
+
+/*
+ * Read a run of a file into the output image
+ *
+ * @state:    Assembler state
+ * @off:      Offset into the image
+ * @fd:       File to read from
+ * @file_off: Offset into the file
+ * @n:        Number of bytes to read
+ *
+ * Returns zero on success
+ */
+int arki_image_load(struct arki_state *state, size_t off, int fd, off_t file_off, size_t n);
+
+/*
+ * Size the output image before the emitting pass
+ *
+ * @state: Assembler state
+ * @size:  Size of the image
+ *
+ * Returns zero on success
+ */
+int arki_image_size(struct arki_state *state, size_t size);
+
+/*
+ * Write out the part of a streamed image still held in
+ * memory
+ *
+ * @state: Assembler state
+ *
+ * Returns zero on success
+ */
+int arki_image_flush(struct arki_state *state);
+
+/*
+ * Release the input already assembled this pass, only
+ * done when streaming
+ *
+ * @state: Assembler state
+ */
+void arki_input_release(struct arki_state *state);
+
+/*
+ * Stream the output image to a file instead of keeping it
+ * in memory, only a small window of it is buffered
+ *
+ * @state: Assembler state
+ * @fd:    File to write the image to
+ *
+ * Returns zero on success
+ */
+int arki_state_stream(struct arki_state *state, int fd);
+
 /*
  * Initialize the assembler state machine
  *
  * @state: Assembler state to initialize
- * @path:  Path of input file
- * @outpath: Output file path name
+ * @path:  Path of input file, must outlive the state
+ *
+ * Returns zero on success
+ */
+int arki_state_init(struct arki_state *state, const char *path);
+
+/*
+ * Initialize the assembler state machine to assemble a
+ * source buffer, the buffer must outlive the state
+ *
+ * @state: Assembler state to initialize
+ * @buf:   Input source buffer
+ * @len:   Length of input source buffer
+ *
+ * Returns zero on success
+ */
+int arki_state_init_buf(struct arki_state *state, const char *buf, size_t len);
+
+/*
+ * Rewind the assembler state machine to before the first
+ * pass, dropping symbols, fixups and any emitted code.
+ *
+ * @state: State to rewind
  *
  * Returns zero on success
  */
-int arki_state_init(struct arki_state *state, const char *path, const char *outpath);
+int arki_state_rewind(struct arki_state *state);
 
 /*
- * Close the assembler state machine
+ * Close the assembler state machine, releasing the output
+ * image and everything else it holds
  *
  * @state: State to close
  */
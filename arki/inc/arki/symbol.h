@@ -7,7 +7,6 @@
 #define ARKI_SYMBOL_H 1
 
 #include <sys/types.h>
-#include <sys/queue.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -29,25 +28,36 @@ typedef enum {
  * @type: Symbol type
  * @id:   Symbol ID
  * @vpc:  Virtual program counter value for symbol
- * @link: Queue link
+ * @hash: Hash of symbol name
  */
 struct symbol {
     char *name;
     sym_type_t type;
     symid_t id;
     uintptr_t vpc;
-    TAILQ_ENTRY(symbol) link;
+    uint32_t hash;
 };
 
 /*
  * Represents the symbol table
  *
+ * Symbols are owned by the dense ID-indexed vector, the
+ * open-addressing hash table references them by name. If
+ * several symbols share a name, the first one defined is
+ * the one found by name.
+ *
  * @sym_count:  Symbol count
- * @entries:    Actual entries
+ * @slots:      Hash table slots, NULL if free
+ * @slot_cap:   Number of hash table slots (power-of-two)
+ * @by_id:      Symbols indexed by ID
+ * @id_cap:     Capacity of ID vector
  */
 struct symbol_table {
     size_t sym_count;
-    TAILQ_HEAD(, symbol) entries;
+    struct symbol **slots;
+    size_t slot_cap;
+    struct symbol **by_id;
+    size_t id_cap;
 };
 
 /*
@@ -18,6 +18,7 @@ typedef enum {
     TT_NUMBER,      /* <NUMBER> */
     TT_COMMENT,     /* <COMMENT> */
     TT_LABEL,       /* <LABEL> */
+    TT_STRING,      /* <STRING> */
     TT_COMMA,       /* ',' */
     TT_AT,          /* '@' */
     TT_NEWLINE,     /* '\n' */
@@ -43,6 +44,10 @@ typedef enum {
     TT_SRR,         /* 'srr' */
     TT_SRW,         /* 'srw' */
     TT_OR,          /* 'or' */
+    TT_ADD,         /* 'add' */
+    TT_SUB,         /* 'sub' */
+    TT_AND,         /* 'and' */
+    TT_XOR,         /* 'xor' */
     TT_LITR,        /* 'litr' */
     TT_STB,         /* 'stb' */
     TT_STW,         /* 'stw' */
@@ -53,11 +58,26 @@ typedef enum {
     TT_LDL,         /* 'ldl' */
     TT_LDQ,         /* 'ldq' */
     TT_B,           /* 'b' */
+    TT_BEQ,         /* 'beq' */
+    TT_BNE,         /* 'bne' */
+    TT_BLT,         /* 'blt' */
+    TT_BGE,         /* 'bge' */
+    TT_BLTU,        /* 'bltu' */
+    TT_BGEU,        /* 'bgeu' */
     TT_BYTE,        /* '.byte' */
+    TT_WORD,        /* '.word' */
+    TT_QUAD,        /* '.quad' */
     TT_SKIP,        /* '.skip' */
     TT_ORIGIN,      /* '.origin' */
+    TT_INCBIN,      /* '.incbin' */
+    TT_ALIGN,       /* '.align' */
+    TT_BALIGN,      /* '.balign' */
 } tt_t;
 
+/* Keyword tokens, each one has a keyword table entry */
+#define TT_KW_FIRST TT_MOV
+#define TT_KW_LAST  TT_BALIGN
+
 /*
  * Represents a lexical token
  */
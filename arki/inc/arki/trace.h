@@ -8,8 +8,19 @@
 
 #include <stdio.h>
 
-#define trace_error(state, fmt, ...)        \
-    printf("[error]: " fmt, ##__VA_ARGS__); \
-    printf("near line %zu\n", (state)->line_num);
+struct arki_state;
+
+/*
+ * Append a formatted diagnostic to the diagnostics of
+ * an assembler state
+ *
+ * @state: Assembler state
+ * @fmt:   Format string
+ */
+void arki_diag(struct arki_state *state, const char *fmt, ...);
+
+#define trace_error(state, fmt, ...)                    \
+    arki_diag((state), "[error]: " fmt, ##__VA_ARGS__); \
+    arki_diag((state), "near line %zu\n", (state)->line_num);
 
 #endif  /* !ARKI_TRACE_H */
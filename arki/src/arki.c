@@ -3,16 +3,53 @@
  * Provided under the BSD-3 clause.
  */
 
+#include <sys/stat.h>
 #include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include "arki/libarki.h"
+#include "arki/prof.h"
 #include "arki/state.h"
-#include "arki/parser.h"
+#include "arki/obj.h"
+#include "arki/cache.h"
 
-#define ARKI_VERSION "0.0.2"
+/* Maximum number of assembler threads */
+#define MAX_JOBS 64
 
-/* Output file name */
-static const char *out_path = DEFAULT_OUT;
+/* Output file name, or directory with several inputs */
+static const char *out_path = NULL;
+
+/* Symbol map and listing file names, or directories */
+static const char *map_path = NULL;
+static const char *list_path = NULL;
+
+/* Write relocatable objects if set */
+static bool obj = false;
+
+/* Number of assembler threads, zero for one per CPU */
+static size_t job_max = 0;
+
+/* Assemble in a single pass if set */
+static bool one_pass = false;
+
+/* Stream images straight to their output files if set */
+static bool stream = false;
+
+/* Timing report after each file if set, as JSON or text */
+static bool prof = false;
+static bool prof_json = false;
+static pthread_mutex_t prof_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Build cache, used if 'cache_dir' is set */
+static struct arki_cache cache;
+static const char *cache_dir = NULL;
+static size_t cache_max = CACHE_DEFAULT_MAX;
+static bool cache_stats = false;
 
 static void
 help(void)
@@ -24,9 +61,30 @@ help(void)
         "[-h]   Display this help menu\n"
         "[-v]   Display the version\n"
         "[-o]   Output file name\n"
+        "[-1]   Single-pass assembly\n"
+        "[-S]   Stream output, for sources too big for memory\n"
+        "[-c]   Output relocatable objects\n"
+        "[-m]   Symbol map file name\n"
+        "[-l]   Listing file name\n"
+        "[-j]   Number of files to assemble at once\n"
+        "[-C]   Build cache directory (or ARKI_CACHE_DIR)\n"
+        "[-L]   Build cache size limit in bytes\n"
+        "[-s]   Display build cache statistics\n"
+        "[-T]   Timing report on stderr, 'text' or 'json'\n"
     );
 }
 
+/*
+ * Set by the Makefile from the assembler sources, fall back
+ * to something that at least changes with every build
+ */
+#ifndef ARKI_BUILD_ID
+#define ARKI_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+/* Assembler the build cache keys are bound to */
+#define CACHE_SALT "arki v" ARKI_VERSION "+" ARKI_BUILD_ID
+
 static void
 version(void)
 {
@@ -34,34 +92,454 @@ version(void)
         "ARK-I assembler for Y-64\n"
         "Copyright (c) 2026 Ian Moffett\n"
         "------------------------------\n"
-        "ARK-I version v%s\n",
-        ARKI_VERSION
+        "ARK-I version v%s (build %s)\n",
+        ARKI_VERSION,
+        ARKI_BUILD_ID
     );
 }
 
+/*
+ * Represents a single input file to be assembled
+ *
+ * @in_path:   Path of input file
+ * @out_path:  Path of output file
+ * @map_path:  Path of symbol map, NULL if none
+ * @list_path: Path of listing, NULL if none
+ * @error:     Set if assembly failed
+ */
+struct arki_job {
+    const char *in_path;
+    char *out_path;
+    char *map_path;
+    char *list_path;
+    bool error;
+};
+
+/* Jobs to run and the next one up for grabs */
+static struct arki_job *jobs;
+static size_t job_count;
+static size_t job_next;
+static pthread_mutex_t job_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Write a buffer out to a file
+ *
+ * @path: Path of file
+ * @buf:  Buffer to write
+ * @len:  Length of buffer
+ *
+ * Returns zero on success
+ */
+static int
+write_file(const char *path, const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+    ssize_t count;
+    int fd;
+
+    fd = open(path, O_WRONLY | O_TRUNC | O_CREAT, 0666);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    while (len > 0) {
+        if ((count = write(fd, p, len)) < 0) {
+            perror(path);
+            close(fd);
+            return -1;
+        }
+
+        p += count;
+        len -= count;
+    }
+
+    close(fd);
+    return 0;
+}
+
+static int
+assemble(const struct arki_job *job)
+{
+    struct arki_options opts;
+    struct arki_result res;
+    uint64_t start = 0, delta;
+    int error;
+
+    memset(&opts, 0, sizeof(opts));
+    opts.one_pass = one_pass;
+    opts.obj = obj;
+    opts.map = job->map_path != NULL;
+    opts.listing = job->list_path != NULL;
+    opts.stream = stream;
+    opts.prof = prof;
+
+    if (stream) {
+        opts.stream_fd = open(job->out_path, O_RDWR | O_CREAT, 0666);
+        if (opts.stream_fd < 0) {
+            perror(job->out_path);
+            return -1;
+        }
+    }
+
+    error = arki_assemble_file(job->in_path, &opts, &res);
+    if (res.diag != NULL) {
+        fputs(res.diag, stdout);
+    } else if (error < 0) {
+        perror(job->in_path);
+    }
+
+    if (res.prof != NULL) {
+        start = arki_prof_now();
+    }
+
+    if (stream) {
+        close(opts.stream_fd);
+    } else if (error == 0) {
+        error = write_file(job->out_path, res.image, res.image_len);
+    }
+
+    if (error == 0 && job->map_path != NULL) {
+        error = write_file(job->map_path, res.map, res.map_len);
+    }
+
+    if (error == 0 && job->list_path != NULL) {
+        error = write_file(job->list_path, res.listing, res.listing_len);
+    }
+
+    /* Writing the outputs is the last of the file I/O */
+    if (error == 0 && res.prof != NULL) {
+        delta = arki_prof_now() - start;
+        res.prof->io.ns += delta;
+        res.prof->total_ns += delta;
+        ++res.prof->io.calls;
+
+        pthread_mutex_lock(&prof_lock);
+        arki_prof_write(res.prof, job->in_path, stderr, prof_json);
+        pthread_mutex_unlock(&prof_lock);
+    }
+
+    arki_result_free(&res);
+    return error;
+}
+
+/*
+ * Assemble a file through the build cache, an unchanged
+ * input assembled with the same options is copied out of
+ * the cache instead.
+ *
+ * @job: Job to assemble
+ *
+ * Returns zero on success
+ */
+static int
+assemble_cached(const struct arki_job *job)
+{
+    char key[CACHE_KEY_LEN + 1];
+    struct cache_item items[3];
+    size_t item_count = 0;
+    const char *salt;
+    int error;
+
+    if (cache_dir == NULL) {
+        return assemble(job);
+    }
+
+    /* Everything besides the input that the output depends on */
+    salt = obj ? CACHE_SALT " -c" : CACHE_SALT;
+    items[item_count].ext = obj ? ".o" : ".bin";
+    items[item_count++].path = job->out_path;
+
+    if (job->map_path != NULL) {
+        items[item_count].ext = ".map";
+        items[item_count++].path = job->map_path;
+    }
+
+    if (job->list_path != NULL) {
+        items[item_count].ext = ".lst";
+        items[item_count++].path = job->list_path;
+    }
+
+    /* Included blobs are not part of the key, do not cache */
+    if (cache_key(job->in_path, salt, key) != 0) {
+        return assemble(job);
+    }
+
+    if ((error = cache_fetch(&cache, key, items, item_count)) == 0) {
+        return 0;
+    }
+
+    if (assemble(job) < 0) {
+        return -1;
+    }
+
+    if (error > 0) {
+        cache_store(&cache, key, items, item_count);
+    }
+
+    return 0;
+}
+
+/*
+ * Assembler thread, runs jobs until there are none left
+ *
+ * @arg: Unused
+ */
+static void *
+assemble_worker(void *arg)
+{
+    struct arki_job *job;
+
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&job_lock);
+        job = (job_next < job_count) ? &jobs[job_next++] : NULL;
+        pthread_mutex_unlock(&job_lock);
+
+        if (job == NULL) {
+            break;
+        }
+
+        job->error = assemble_cached(job) < 0;
+    }
+
+    return NULL;
+}
+
+/*
+ * Derive the output path of an input file when assembling
+ * several at once, "dir/name.asm" becomes "<out_dir>/name.bin",
+ * or "dir/name.bin" if there is no output directory.
+ *
+ * @in_path: Path of input file
+ * @out_dir: Output directory, NULL if none
+ * @out_ext: Output extension (e.g., ".bin")
+ *
+ * Returns the allocated output path on success
+ */
+static char *
+job_out_path(const char *in_path, const char *out_dir, const char *out_ext)
+{
+    const char *base, *ext;
+    size_t dir_len, base_len;
+    char *res;
+
+    base = strrchr(in_path, '/');
+    base = (base == NULL) ? in_path : base + 1;
+    ext = strrchr(base, '.');
+    base_len = (ext == NULL || ext == base) ? strlen(base) : (size_t)(ext - base);
+
+    if (out_dir == NULL) {
+        out_dir = in_path;
+        dir_len = base - in_path;
+    } else {
+        dir_len = strlen(out_dir) + 1;
+    }
+
+    if ((res = malloc(dir_len + base_len + strlen(out_ext) + 1)) == NULL) {
+        return NULL;
+    }
+
+    memcpy(res, out_dir, dir_len);
+    if (out_dir != in_path) {
+        res[dir_len - 1] = '/';
+    }
+
+    memcpy(&res[dir_len], base, base_len);
+    memcpy(&res[dir_len + base_len], out_ext, strlen(out_ext) + 1);
+    return res;
+}
+
+/*
+ * Make sure an output option names a directory, as it
+ * must with several inputs, creating it if missing
+ *
+ * @path: Path given to option
+ * @opt:  Option character
+ *
+ * Returns zero if so
+ */
+static int
+jobs_check_dir(const char *path, char opt)
+{
+    struct stat st;
+
+    if (path == NULL) {
+        return 0;
+    }
+
+    if (stat(path, &st) < 0) {
+        if (errno != ENOENT || mkdir(path, 0755) < 0) {
+            printf("fatal: cannot create -%c directory %s\n", opt, path);
+            return -1;
+        }
+
+        return 0;
+    }
+
+    if (!S_ISDIR(st.st_mode)) {
+        printf("fatal: -%c must be a directory with several inputs\n", opt);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Set up one job per input file
+ *
+ * @paths: Input file paths
+ * @count: Number of input files
+ *
+ * Returns zero on success
+ */
 static int
-assemble(const char *path)
+jobs_init(char **paths, size_t count)
 {
-    struct arki_state state;
+    const char *out_dir = NULL;
 
-    if (arki_state_init(&state, path, out_path) < 0) {
-        perror("arki_state_init");
+    if ((jobs = calloc(count, sizeof(*jobs))) == NULL) {
+        perror("calloc");
         return -1;
     }
 
-    for (int i = 0; i < PASS_COUNT; ++i) {
-        if (arki_parse(&state) < 0) {
+    job_count = count;
+    if (count == 1) {
+        jobs[0].in_path = paths[0];
+        if (out_path == NULL) {
+            out_path = obj ? DEFAULT_OBJ_OUT : DEFAULT_OUT;
+        }
+
+        jobs[0].out_path = strdup(out_path);
+        if (jobs[0].out_path == NULL) {
             return -1;
         }
+
+        if (map_path != NULL && (jobs[0].map_path = strdup(map_path)) == NULL) {
+            return -1;
+        }
+
+        if (list_path != NULL && (jobs[0].list_path = strdup(list_path)) == NULL) {
+            return -1;
+        }
+
+        return 0;
+    }
+
+    /* Several inputs need output directories */
+    if (jobs_check_dir(out_path, 'o') < 0) {
+        return -1;
+    }
+
+    if (jobs_check_dir(map_path, 'm') < 0) {
+        return -1;
+    }
+
+    if (jobs_check_dir(list_path, 'l') < 0) {
+        return -1;
+    }
+
+    out_dir = out_path;
+    for (size_t i = 0; i < count; ++i) {
+        jobs[i].in_path = paths[i];
+        jobs[i].out_path = job_out_path(paths[i], out_dir, obj ? ".o" : ".bin");
+        if (jobs[i].out_path == NULL) {
+            perror("job_out_path");
+            return -1;
+        }
+
+        if (map_path != NULL) {
+            jobs[i].map_path = job_out_path(paths[i], map_path, ".map");
+            if (jobs[i].map_path == NULL) {
+                perror("job_out_path");
+                return -1;
+            }
+        }
+
+        if (list_path != NULL) {
+            jobs[i].list_path = job_out_path(paths[i], list_path, ".lst");
+            if (jobs[i].list_path == NULL) {
+                perror("job_out_path");
+                return -1;
+            }
+        }
+
+        for (size_t j = 0; j < i; ++j) {
+            if (strcmp(jobs[i].out_path, jobs[j].out_path) == 0) {
+                printf(
+                    "fatal: %s and %s both output to %s\n",
+                    jobs[j].in_path,
+                    jobs[i].in_path,
+                    jobs[i].out_path
+                );
+                return -1;
+            }
+        }
     }
 
-    arki_state_close(&state);
     return 0;
 }
 
+/*
+ * Run every job on a pool of assembler threads
+ *
+ * Returns the number of jobs that failed
+ */
+static size_t
+jobs_run(void)
+{
+    pthread_t threads[MAX_JOBS];
+    size_t thread_count, failed = 0;
+    long ncpu;
+
+    thread_count = job_max;
+    if (thread_count == 0) {
+        ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = (ncpu > 0) ? ncpu : 1;
+    }
+
+    if (thread_count > job_count) {
+        thread_count = job_count;
+    }
+
+    if (thread_count > MAX_JOBS) {
+        thread_count = MAX_JOBS;
+    }
+
+    /* No need for threads if only one would run */
+    if (thread_count <= 1) {
+        assemble_worker(NULL);
+        thread_count = 0;
+    }
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        if (pthread_create(&threads[i], NULL, assemble_worker, NULL) != 0) {
+            thread_count = i;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* Pick up jobs left over if threads could not be created */
+    assemble_worker(NULL);
+    for (size_t i = 0; i < job_count; ++i) {
+        failed += jobs[i].error;
+        free(jobs[i].out_path);
+        free(jobs[i].map_path);
+        free(jobs[i].list_path);
+    }
+
+    free(jobs);
+    return failed;
+}
+
 int
 main(int argc, char **argv)
 {
+    size_t failed;
     int opt;
 
     if (argc < 2) {
@@ -69,7 +547,7 @@ main(int argc, char **argv)
         help();
     }
 
-    while ((opt = getopt(argc, argv, "hvo:")) != -1) {
+    while ((opt = getopt(argc, argv, "hvo:1Scm:l:j:C:L:sT:")) != -1) {
         switch (opt) {
         case 'h':
             help();
@@ -80,12 +558,81 @@ main(int argc, char **argv)
         case 'o':
             out_path = strdup(optarg);
             break;
+        case '1':
+            one_pass = true;
+            break;
+        case 'S':
+            stream = true;
+            break;
+        case 'c':
+            obj = true;
+            break;
+        case 'm':
+            map_path = optarg;
+            break;
+        case 'l':
+            list_path = optarg;
+            break;
+        case 'j':
+            job_max = atoi(optarg);
+            break;
+        case 'C':
+            cache_dir = optarg;
+            break;
+        case 'L':
+            cache_max = strtoull(optarg, NULL, 0);
+            break;
+        case 's':
+            cache_stats = true;
+            break;
+        case 'T':
+            if (strcmp(optarg, "text") != 0 && strcmp(optarg, "json") != 0) {
+                printf("fatal: -T takes 'text' or 'json'\n");
+                return -1;
+            }
+
+            prof = true;
+            prof_json = strcmp(optarg, "json") == 0;
+            break;
         }
     }
 
-    while (optind < argc) {
-        assemble(argv[optind++]);
+    /* Objects are not placed yet, they have no addresses to map */
+    if (obj && map_path != NULL) {
+        printf("fatal: -m cannot be used with -c, map the linked image\n");
+        return -1;
     }
 
-    return 0;
+    /* Both need the whole image in memory */
+    if (stream && (obj || list_path != NULL)) {
+        printf("fatal: -S cannot be used with -c or -l\n");
+        return -1;
+    }
+
+    if (cache_dir == NULL) {
+        cache_dir = getenv("ARKI_CACHE_DIR");
+    }
+
+    if (cache_dir != NULL && cache_init(&cache, cache_dir, cache_max) < 0) {
+        perror("cache_init");
+        cache_dir = NULL;
+    }
+
+    if (optind >= argc) {
+        return -1;
+    }
+
+    if (jobs_init(&argv[optind], argc - optind) < 0) {
+        return -1;
+    }
+
+    failed = jobs_run();
+    if (cache_dir != NULL) {
+        cache_evict(&cache);
+        if (cache_stats) {
+            cache_dump_stats(&cache);
+        }
+    }
+
+    return (failed == 0) ? 0 : 1;
 }
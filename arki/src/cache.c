@@ -0,0 +1,391 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include "arki/cache.h"
+
+/* Block size used when copying */
+#define CACHE_COPY_BLOCK 65536
+
+/*
+ * Represents a cache entry found while evicting
+ *
+ * @name:  Entry file name
+ * @size:  Size of entry
+ * @mtime: Last time entry was used
+ */
+struct cache_entry {
+    char name[NAME_MAX + 1];
+    off_t size;
+    struct timespec mtime;
+};
+
+/* Directive that pulls other files into an output */
+#define CACHE_INCBIN     ".incbin"
+#define CACHE_INCBIN_LEN (sizeof(CACHE_INCBIN) - 1)
+
+/* Counter used to name temporary files */
+static size_t tmp_count = 0;
+
+/*
+ * Copy one file to another, sharing the extents if the
+ * filesystem can reflink
+ *
+ * @src: Source path
+ * @dst: Destination path
+ *
+ * Returns zero on success
+ */
+static int
+cache_copy(const char *src, const char *dst)
+{
+    char buf[CACHE_COPY_BLOCK];
+    ssize_t count, done;
+    int in_fd, out_fd;
+    int error = 0;
+
+    if ((in_fd = open(src, O_RDONLY)) < 0) {
+        return -1;
+    }
+
+    out_fd = open(dst, O_WRONLY | O_TRUNC | O_CREAT, 0666);
+    if (out_fd < 0) {
+        close(in_fd);
+        return -1;
+    }
+
+    if (ioctl(out_fd, FICLONE, in_fd) == 0) {
+        close(in_fd);
+        close(out_fd);
+        return 0;
+    }
+
+    while ((count = read(in_fd, buf, sizeof(buf))) > 0) {
+        for (done = 0; done < count; done += error) {
+            if ((error = write(out_fd, &buf[done], count - done)) < 0) {
+                break;
+            }
+        }
+
+        if (error < 0) {
+            break;
+        }
+    }
+
+    close(in_fd);
+    close(out_fd);
+    return (count < 0 || error < 0) ? -1 : 0;
+}
+
+/*
+ * Returns true if a source buffer uses '.incbin'
+ *
+ * @buf: Source buffer
+ * @len: Length of source buffer
+ */
+static bool
+cache_has_incbin(const char *buf, size_t len)
+{
+    const char *p = buf, *end = buf + len;
+
+    while ((size_t)(end - p) >= CACHE_INCBIN_LEN) {
+        if ((p = memchr(p, '.', end - p)) == NULL) {
+            return false;
+        }
+
+        if ((size_t)(end - p) < CACHE_INCBIN_LEN) {
+            return false;
+        }
+
+        if (memcmp(p, CACHE_INCBIN, CACHE_INCBIN_LEN) == 0) {
+            return true;
+        }
+
+        ++p;
+    }
+
+    return false;
+}
+
+/*
+ * Compare two cache entries by last use
+ */
+static int
+cache_entry_cmp(const void *a, const void *b)
+{
+    const struct cache_entry *ea = a, *eb = b;
+
+    if (ea->mtime.tv_sec != eb->mtime.tv_sec) {
+        return (ea->mtime.tv_sec < eb->mtime.tv_sec) ? -1 : 1;
+    }
+
+    if (ea->mtime.tv_nsec != eb->mtime.tv_nsec) {
+        return (ea->mtime.tv_nsec < eb->mtime.tv_nsec) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+int
+cache_init(struct arki_cache *cache, const char *dir, size_t size_max)
+{
+    if (cache == NULL || dir == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (mkdir(dir, 0777) < 0 && errno != EEXIST) {
+        return -1;
+    }
+
+    memset(cache, 0, sizeof(*cache));
+    cache->dir = dir;
+    cache->size_max = size_max;
+    pthread_mutex_init(&cache->lock, NULL);
+    return 0;
+}
+
+int
+cache_key(const char *path, const char *salt, char res[CACHE_KEY_LEN + 1])
+{
+    static const char hex[] = "0123456789abcdef";
+    char buf[CACHE_INCBIN_LEN + CACHE_COPY_BLOCK];
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    struct sha256 ctx;
+    struct stat st;
+    ssize_t count;
+    size_t carry = 0;
+    bool incbin = false;
+    void *mem;
+    int fd;
+
+    if (path == NULL || salt == NULL || res == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return -1;
+    }
+
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    sha256_init(&ctx);
+    sha256_update(&ctx, salt, strlen(salt) + 1);
+
+    mem = MAP_FAILED;
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        mem = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    if (mem != MAP_FAILED) {
+        sha256_update(&ctx, mem, st.st_size);
+        incbin = cache_has_incbin(mem, st.st_size);
+        munmap(mem, st.st_size);
+    } else {
+        /* Blocks keep the tail of the last one to search across */
+        while ((count = read(fd, &buf[carry], CACHE_COPY_BLOCK)) > 0) {
+            sha256_update(&ctx, &buf[carry], count);
+            incbin = incbin || cache_has_incbin(buf, carry + count);
+
+            count += carry;
+            carry = ((size_t)count < CACHE_INCBIN_LEN) ? count : CACHE_INCBIN_LEN - 1;
+            memmove(buf, &buf[count - carry], carry);
+        }
+
+        if (count < 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    close(fd);
+    sha256_final(&ctx, digest);
+    for (int i = 0; i < SHA256_DIGEST_SIZE; ++i) {
+        res[i * 2] = hex[digest[i] >> 4];
+        res[i * 2 + 1] = hex[digest[i] & 0xF];
+    }
+
+    res[CACHE_KEY_LEN] = '\0';
+    return incbin ? 1 : 0;
+}
+
+int
+cache_fetch(struct arki_cache *cache, const char *key,
+    const struct cache_item *items, size_t count)
+{
+    char path[PATH_MAX];
+
+    if (cache == NULL || key == NULL || items == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(path, sizeof(path), "%s/%s%s", cache->dir, key, items[i].ext);
+        if (access(path, R_OK) < 0) {
+            pthread_mutex_lock(&cache->lock);
+            ++cache->misses;
+            pthread_mutex_unlock(&cache->lock);
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(path, sizeof(path), "%s/%s%s", cache->dir, key, items[i].ext);
+        if (cache_copy(path, items[i].path) < 0) {
+            return -1;
+        }
+
+        /* Mark as recently used */
+        utimensat(AT_FDCWD, path, NULL, 0);
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    ++cache->hits;
+    pthread_mutex_unlock(&cache->lock);
+    return 0;
+}
+
+int
+cache_store(struct arki_cache *cache, const char *key,
+    const struct cache_item *items, size_t count)
+{
+    char path[PATH_MAX], tmp[PATH_MAX];
+    size_t n;
+
+    if (cache == NULL || key == NULL || items == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        pthread_mutex_lock(&cache->lock);
+        n = tmp_count++;
+        pthread_mutex_unlock(&cache->lock);
+
+        /*
+         * Copy to a temporary file first so other assemblers
+         * never see a partial entry.
+         */
+        snprintf(path, sizeof(path), "%s/%s%s", cache->dir, key, items[i].ext);
+        snprintf(tmp, sizeof(tmp), "%s/.tmp.%ld.%zu", cache->dir, (long)getpid(), n);
+        if (cache_copy(items[i].path, tmp) < 0) {
+            unlink(tmp);
+            return -1;
+        }
+
+        if (rename(tmp, path) < 0) {
+            unlink(tmp);
+            return -1;
+        }
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    ++cache->stores;
+    pthread_mutex_unlock(&cache->lock);
+    return 0;
+}
+
+void
+cache_evict(struct arki_cache *cache)
+{
+    struct cache_entry *entries = NULL, *tmp;
+    struct dirent *dirent;
+    struct stat st;
+    size_t count = 0, cap = 0;
+    off_t total = 0;
+    DIR *dir;
+    int dfd;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    if ((dir = opendir(cache->dir)) == NULL) {
+        return;
+    }
+
+    dfd = dirfd(dir);
+    while ((dirent = readdir(dir)) != NULL) {
+        /* Skip temporary files and anything not ours */
+        if (dirent->d_name[0] == '.' || strlen(dirent->d_name) < CACHE_KEY_LEN) {
+            continue;
+        }
+
+        if (fstatat(dfd, dirent->d_name, &st, 0) < 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+
+        if (count >= cap) {
+            cap = (cap == 0) ? 64 : cap * 2;
+            if ((tmp = realloc(entries, cap * sizeof(*tmp))) == NULL) {
+                break;
+            }
+
+            entries = tmp;
+        }
+
+        snprintf(entries[count].name, sizeof(entries[count].name), "%s", dirent->d_name);
+        entries[count].size = st.st_size;
+        entries[count].mtime = st.st_mtim;
+        total += st.st_size;
+        ++count;
+    }
+
+    if (total > (off_t)cache->size_max) {
+        qsort(entries, count, sizeof(*entries), cache_entry_cmp);
+        for (size_t i = 0; i < count && total > (off_t)cache->size_max; ++i) {
+            if (unlinkat(dfd, entries[i].name, 0) == 0) {
+                total -= entries[i].size;
+                ++cache->evicted;
+            }
+        }
+    }
+
+    closedir(dir);
+    free(entries);
+}
+
+void
+cache_dump_stats(struct arki_cache *cache)
+{
+    size_t total;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    total = cache->hits + cache->misses;
+    printf(
+        "[*] cache: %s, %zu byte limit\n"
+        "[*] cache: hits=%zu misses=%zu stores=%zu evictions=%zu",
+        cache->dir, cache->size_max,
+        cache->hits, cache->misses, cache->stores, cache->evicted
+    );
+
+    if (total > 0) {
+        printf(" hit rate=%zu.%02zu%%", (cache->hits * 100) / total,
+            ((cache->hits * 10000) / total) % 100);
+    }
+
+    printf("\n");
+}
@@ -3,42 +3,163 @@
  * Provided under the BSD-3 clause.
  */
 
+#include <sys/stat.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <errno.h>
 #include "arki/codegen.h"
+#include "arki/isa.h"
 #include "arki/trace.h"
 
 /* Various parameters */
-#define SHORT_IMM_MAX (1 << 16)
-
-/* Valid opcodes */
-#define OPC_WMOV  0x01  /* Wide IMM move */
-#define OPC_SMOV  0x03  /* Short IMM register load */
-#define OPC_HLT   0x0D  /* Halt processor */
-#define OPC_SRR   0x0E  /* Special register read */
-#define OPC_SRW   0x0F  /* Special register write */
-#define OPC_IOR   0x10  /* IMM OR */
-#define OPC_LITR  0x14  /* Load ITR */
-#define OPC_STB   0x15  /* Store byte */
-#define OPC_STW   0x16  /* Store word */
-#define OPC_STL   0x17  /* Store dword */
-#define OPC_STQ   0x18  /* Store qword */
-#define OPC_LDB   0x19  /* Load byte */
-#define OPC_LDW   0x1A  /* Load word */
-#define OPC_LDL   0x1B  /* Load dword */
-#define OPC_LDQ   0x1C  /* Load qword */
-#define OPC_B     0x1D  /* Indirect branch */
-
-#define cg_emitb(state, byte) do {          \
-        uint8_t b = (byte);                 \
-                                            \
-        if ((state)->pass_count == 1) {     \
-            write((state)->out_fd, &b, 1);  \
-        }                                   \
-                                            \
-        ++(state)->vpc;                     \
-    } while (0);
+#define SHORT_IMM_MAX 0xFFFF
+
+/* Opcode table generated from the ISA description */
+static const struct isa_inst isa_tab[ISA_OPCODE_MAX] = {
+    ISA_INSTS(ISA_INST_ENTRY)
+};
+
+/*
+ * Emit a single byte
+ *
+ * @state: Assembler state
+ * @byte:  Byte to emit
+ *
+ * Returns zero on success
+ */
+static int
+cg_emitb(struct arki_state *state, uint8_t byte)
+{
+    if (arki_emitting(state)) {
+        if (arki_image_write(state, state->vpc, &byte, 1) < 0) {
+            trace_error(state, "failed to write byte\n");
+            return -1;
+        }
+    }
+
+    ++state->vpc;
+    return 0;
+}
+
+/*
+ * Encode an instruction through the opcode table and emit
+ * it, the length always comes from its format
+ *
+ * @state:  Assembler state
+ * @opcode: Opcode of instruction
+ * @rd:     Destination register
+ * @rs:     Source register
+ * @imm:    Immediate
+ *
+ * Returns zero on success
+ */
+static int
+cg_emit_inst(struct arki_state *state, uint8_t opcode, uint8_t rd, uint8_t rs, uint64_t imm)
+{
+    const struct isa_inst *inst = &isa_tab[opcode];
+    uint8_t buf[sizeof(uint64_t)];
+    uint64_t raw;
+
+    if (inst->fmt == ISA_FMT_NONE) {
+        trace_error(state, "bad opcode %02x\n", opcode);
+        return -1;
+    }
+
+    if (arki_emitting(state)) {
+        raw = isa_encode(inst->fmt, opcode, rd, rs, imm);
+        for (size_t i = 0; i < inst->len; ++i) {
+            buf[i] = (raw >> (i * 8)) & 0xFF;
+        }
+
+        if (arki_image_write(state, state->vpc, buf, inst->len) < 0) {
+            trace_error(state, "failed to write instruction\n");
+            return -1;
+        }
+    }
+
+    state->vpc += inst->len;
+    return 0;
+}
+
+/*
+ * Size a mov whose immediate is a label
+ *
+ * Sizing passes start every such mov out short and only
+ * ever widen them, so label addresses can only grow and
+ * the layout is bound to converge. The decision made on
+ * the last sizing pass is replayed when emitting.
+ *
+ * Forward references on the first sizing pass are noted
+ * and checked by cg_settle_movs() once every label is
+ * known, so only those that do not fit cost another pass.
+ *
+ * @state:  Assembler state
+ * @symbol: Label symbol, NULL if not yet defined
+ * @name:   Label name
+ * @wide:   Set if the mov must be wide
+ *
+ * Returns zero on success
+ */
+static int
+cg_size_label_mov(struct arki_state *state, struct symbol *symbol,
+    const char *name, bool *wide)
+{
+    size_t idx, cap;
+    uint8_t *tmp;
+    int error;
+
+    if (state->one_pass) {
+        *wide = symbol != NULL && symbol->vpc > SHORT_IMM_MAX;
+        return 0;
+    }
+
+    /* Addresses are not known until link time */
+    if (state->obj) {
+        *wide = true;
+        return 0;
+    }
+
+    idx = state->mov_idx++;
+    if (idx >= state->mov_cap) {
+        cap = (state->mov_cap == 0) ? 256 : state->mov_cap * 2;
+        if ((tmp = realloc(state->mov_wide, cap)) == NULL) {
+            errno = -ENOMEM;
+            return -1;
+        }
+
+        memset(&tmp[state->mov_cap], 0, cap - state->mov_cap);
+        state->mov_wide = tmp;
+        state->mov_cap = cap;
+    }
+
+    if (state->pass_count == 0) {
+        if (symbol == NULL) {
+            error = fixup_table_add(
+                &state->fixups,
+                FIXUP_MOVSZ,
+                name,
+                idx,
+                0,
+                state->line_num
+            );
+
+            if (error < 0) {
+                return -1;
+            }
+        } else if (!state->mov_wide[idx] && symbol->vpc > SHORT_IMM_MAX) {
+            state->mov_wide[idx] = 1;
+            state->unsettled = true;
+        }
+    }
+
+    *wide = state->mov_wide[idx];
+    return 0;
+}
 
 /*
  * Generate code for the 'mov' instruction
@@ -53,10 +174,10 @@ cg_emit_mov(struct arki_state *state, struct ast_node *root)
 {
     struct symbol *symbol;
     struct ast_node *lhs, *rhs;
-    uint8_t opcode = OPC_SMOV;
-    size_t byte_count = 0;
-    size_t max_bytes = 2;
+    uint8_t opcode = ISA_OPC_IMOVS;
     uintptr_t imm = 0;
+    bool wide = false;
+    int error;
 
     if (state == NULL || root == NULL) {
         return -1;
@@ -70,18 +191,75 @@ cg_emit_mov(struct arki_state *state, struct ast_node *root)
         return -1;
     }
 
-    /* TODO: Support register moves */
     switch (rhs->type) {
+    case AST_REG:
+        if (lhs->reg >= REG_MAX) {
+            trace_error(state, "bad lhs register\n");
+            return -1;
+        }
+
+        return cg_emit_inst(state, ISA_OPC_MOV, lhs->reg, rhs->reg, 0);
     case AST_NUMBER:
         imm = rhs->v;
         break;
     case AST_LABEL:
-        if ((symbol = rhs->symbol) == NULL && state->pass_count > 0) {
-            trace_error(state, "mov rhs hsa no symbol\n");
-            return -1;
+        symbol = rhs->symbol;
+
+        /* Every label exists after the first sizing pass */
+        if (symbol == NULL && !state->obj) {
+            if (state->pass_count > 0 || state->relax_pass > 0) {
+                trace_error(state, "undefined reference to '%s'\n", rhs->name);
+                return -1;
+            }
         }
 
         imm = (symbol != NULL) ? symbol->vpc : 0xFF;
+        if (cg_size_label_mov(state, symbol, rhs->name, &wide) < 0) {
+            trace_error(state, "failed to size mov\n");
+            return -1;
+        }
+
+        /*
+         * In single-pass mode, forward references are emitted as
+         * short moves just like on the sizing pass and the
+         * immediate is patched once the label is known.
+         */
+        if (symbol == NULL && state->one_pass) {
+            error = fixup_table_add(
+                &state->fixups,
+                FIXUP_IMM16,
+                rhs->name,
+                state->vpc + ISA_IMM_SHIFT / 8,
+                0,
+                state->line_num
+            );
+
+            if (error < 0) {
+                trace_error(state, "failed to allocate fixup\n");
+                return -1;
+            }
+        }
+
+        /* Objects leave the immediate to the linker */
+        if (state->obj) {
+            imm = 0;
+        }
+
+        if (state->obj && arki_emitting(state)) {
+            error = fixup_table_add(
+                &state->fixups,
+                FIXUP_IMM48,
+                rhs->name,
+                state->vpc + ISA_IMM_SHIFT / 8,
+                0,
+                state->line_num
+            );
+
+            if (error < 0) {
+                trace_error(state, "failed to allocate relocation\n");
+                return -1;
+            }
+        }
         break;
     default:
         trace_error(state, "unexpectd rhs type %d for mov\n", rhs->type);
@@ -89,9 +267,23 @@ cg_emit_mov(struct arki_state *state, struct ast_node *root)
     }
 
     /* Should we use a wide move? */
-    if (imm > SHORT_IMM_MAX) {
-        opcode = OPC_WMOV;
-        max_bytes = 6;
+    if (rhs->type == AST_NUMBER && imm > SHORT_IMM_MAX) {
+        wide = true;
+    }
+
+    if (wide) {
+        opcode = ISA_OPC_IMOV;
+    }
+
+    /* Sizing must never leave a value too big for a short mov */
+    if (!wide && (uint64_t)imm > SHORT_IMM_MAX) {
+        trace_error(state, "imm of short mov does not fit in 16 bits\n");
+        return -1;
+    }
+
+    if ((uint64_t)imm >> ISA_IMM_BITS_C != 0) {
+        trace_error(state, "imm of mov does not fit in 48 bits\n");
+        return -1;
     }
 
     if (lhs->reg >= REG_MAX) {
@@ -99,14 +291,7 @@ cg_emit_mov(struct arki_state *state, struct ast_node *root)
         return -1;
     }
 
-    cg_emitb(state, opcode);
-    cg_emitb(state, lhs->reg);
-    while (imm != 0 || byte_count < max_bytes) {
-        cg_emitb(state, imm & 0xFF);
-        imm >>= 8;
-        ++byte_count;
-    }
-    return 0;
+    return cg_emit_inst(state, opcode, lhs->reg, 0, imm);
 }
 
 /*
@@ -124,8 +309,7 @@ cg_emit_hlt(struct arki_state *state, struct ast_node *root)
         return -1;
     }
 
-    cg_emitb(state, OPC_HLT);
-    return 0;
+    return cg_emit_inst(state, ISA_OPC_HLT, 0, 0, 0);
 }
 
 /*
@@ -143,8 +327,7 @@ cg_emit_srr(struct arki_state *state, struct ast_node *root)
         return -1;
     }
 
-    cg_emitb(state, OPC_SRR);
-    return 0;
+    return cg_emit_inst(state, ISA_OPC_SRR, 0, 0, 0);
 }
 
 /*
@@ -162,12 +345,12 @@ cg_emit_srw(struct arki_state *state, struct ast_node *root)
         return -1;
     }
 
-    cg_emitb(state, OPC_SRW);
-    return 0;
+    return cg_emit_inst(state, ISA_OPC_SRW, 0, 0, 0);
 }
 
 /*
- * Generate code for the 'or' instruction
+ * Generate code for an ALU instruction, the source picks
+ * between the register and immediate forms
  *
  * @state: Assembler state
  * @root:  Root node to resolve
@@ -175,26 +358,54 @@ cg_emit_srw(struct arki_state *state, struct ast_node *root)
  * Returns zero on success
  */
 static int
-cg_emit_or(struct arki_state *state, struct ast_node *root)
+cg_emit_alu(struct arki_state *state, struct ast_node *root)
 {
     struct ast_node *lhs, *rhs;
-    size_t byte_count = 0;
+    const char *name;
+    uint8_t reg_opc;
+    int imm_opc;
 
     if (state == NULL || root == NULL) {
         return -1;
     }
 
+    /* 'and' and 'xor' have no immediate form */
+    switch (root->type) {
+    case AST_OR:
+        name = "or";
+        imm_opc = ISA_OPC_IOR;
+        reg_opc = ISA_OPC_OR;
+        break;
+    case AST_ADD:
+        name = "add";
+        imm_opc = ISA_OPC_IADD;
+        reg_opc = ISA_OPC_ADD;
+        break;
+    case AST_SUB:
+        name = "sub";
+        imm_opc = ISA_OPC_ISUB;
+        reg_opc = ISA_OPC_SUB;
+        break;
+    case AST_AND:
+        name = "and";
+        imm_opc = -1;
+        reg_opc = ISA_OPC_AND;
+        break;
+    case AST_XOR:
+        name = "xor";
+        imm_opc = -1;
+        reg_opc = ISA_OPC_XOR;
+        break;
+    default:
+        trace_error(state, "emit alu root not an alu instruction\n");
+        return -1;
+    }
+
     lhs = root->left;
     rhs = root->right;
 
     if (lhs->type != AST_REG) {
-        trace_error(state, "lhs of or is not a register\n");
-        return -1;
-    }
-
-    /* TODO: Support register ORs */
-    if (rhs->type != AST_NUMBER) {
-        trace_error(state, "rhs of or is not an imm\n");
+        trace_error(state, "lhs of %s is not a register\n", name);
         return -1;
     }
 
@@ -203,14 +414,25 @@ cg_emit_or(struct arki_state *state, struct ast_node *root)
         return -1;
     }
 
-    cg_emitb(state, OPC_IOR);
-    cg_emitb(state, lhs->reg);
-    while (rhs->v != 0 || byte_count < 2) {
-        cg_emitb(state, rhs->v & 0xFF);
-        rhs->v >>= 8;
-        ++byte_count;
+    switch (rhs->type) {
+    case AST_REG:
+        return cg_emit_inst(state, reg_opc, lhs->reg, rhs->reg, 0);
+    case AST_NUMBER:
+        if (imm_opc < 0) {
+            trace_error(state, "%s takes no imm\n", name);
+            return -1;
+        }
+
+        if (rhs->v < 0 || rhs->v > SHORT_IMM_MAX) {
+            trace_error(state, "imm of %s does not fit in 16 bits\n", name);
+            return -1;
+        }
+
+        return cg_emit_inst(state, imm_opc, lhs->reg, 0, rhs->v);
+    default:
+        trace_error(state, "rhs of %s is not a register or imm\n", name);
+        return -1;
     }
-    return 0;
 }
 
 /*
@@ -236,9 +458,7 @@ cg_emit_litr(struct arki_state *state, struct ast_node *root)
         return -1;
     }
 
-    cg_emitb(state, OPC_LITR);
-    cg_emitb(state, root->reg);
-    return 0;
+    return cg_emit_inst(state, ISA_OPC_LITR, root->reg, 0, 0);
 }
 
 /*
@@ -259,16 +479,16 @@ cg_emit_store(struct arki_state *state, struct ast_node *root)
 
     switch (root->type) {
     case AST_STB:
-        opcode = OPC_STB;
+        opcode = ISA_OPC_STB;
         break;
     case AST_STW:
-        opcode = OPC_STW;
+        opcode = ISA_OPC_STW;
         break;
     case AST_STL:
-        opcode = OPC_STL;
+        opcode = ISA_OPC_STL;
         break;
     case AST_STQ:
-        opcode = OPC_STQ;
+        opcode = ISA_OPC_STQ;
         break;
     default:
         return -1;
@@ -294,10 +514,7 @@ cg_emit_store(struct arki_state *state, struct ast_node *root)
         return -1;
     }
 
-    cg_emitb(state, opcode);
-    cg_emitb(state, lhs->reg);
-    cg_emitb(state, rhs->reg);
-    return 0;
+    return cg_emit_inst(state, opcode, lhs->reg, rhs->reg, 0);
 }
 
 /*
@@ -318,16 +535,16 @@ cg_emit_load(struct arki_state *state, struct ast_node *root)
 
     switch (root->type) {
     case AST_LDB:
-        opcode = OPC_LDB;
+        opcode = ISA_OPC_LDB;
         break;
     case AST_LDW:
-        opcode = OPC_LDW;
+        opcode = ISA_OPC_LDW;
         break;
     case AST_LDL:
-        opcode = OPC_LDL;
+        opcode = ISA_OPC_LDL;
         break;
     case AST_LDQ:
-        opcode = OPC_LDQ;
+        opcode = ISA_OPC_LDQ;
         break;
     default:
         return -1;
@@ -353,36 +570,60 @@ cg_emit_load(struct arki_state *state, struct ast_node *root)
         return -1;
     }
 
-    cg_emitb(state, opcode);
-    cg_emitb(state, lhs->reg);
-    cg_emitb(state, rhs->reg);
-    return 0;
+    return cg_emit_inst(state, opcode, lhs->reg, rhs->reg, 0);
 }
 
 /*
- * Emit bytes to output file
+ * Emit the numbers of a data directive, little-endian
  *
  * @state: Assembler state
  * @root:  Root node
  */
 static int
-cg_emit_bytes(struct arki_state *state, struct ast_node *root)
+cg_emit_data(struct arki_state *state, struct ast_node *root)
 {
     struct ast_node *cur;
+    size_t width;
 
     if (state == NULL || root == NULL) {
         return -1;
     }
 
-    if (root->type != AST_BYTE) {
-        trace_error(state, "emit bytes root not AST_BYTE\n");
+    switch (root->type) {
+    case AST_BYTE:
+        width = 1;
+        break;
+    case AST_WORD:
+        width = 2;
+        break;
+    case AST_QUAD:
+        width = 8;
+        break;
+    default:
+        trace_error(state, "emit data root not a data directive\n");
         return -1;
     }
 
-    cur = root->right;
-    while (cur != NULL) {
-        cg_emitb(state, cur->v & 0xFF);
-        cur = cur->right;
+    for (cur = root->right; cur != NULL; cur = cur->right) {
+        if (cur->type != AST_DATA) {
+            for (size_t i = 0; i < width; ++i) {
+                if (cg_emitb(state, ((size_t)cur->v >> (i * 8)) & 0xFF) < 0) {
+                    return -1;
+                }
+            }
+
+            continue;
+        }
+
+        /* A run of numbers already laid out as bytes */
+        if (arki_emitting(state)) {
+            if (arki_image_write(state, state->vpc, cur->data, cur->v) < 0) {
+                trace_error(state, "failed to write %zd bytes\n", cur->v);
+                return -1;
+            }
+        }
+
+        state->vpc += cur->v;
     }
 
     return 0;
@@ -414,9 +655,87 @@ cg_emit_branch(struct arki_state *state, struct ast_node *root)
         return -1;
     }
 
-    cg_emitb(state, OPC_B);
-    cg_emitb(state, rhs->reg);
-    return 0;
+    return cg_emit_inst(state, ISA_OPC_B, rhs->reg, 0, 0);
+}
+
+/*
+ * Emit a compare-and-branch, the displacement is taken
+ * from the address of the branch itself
+ *
+ * @state: Assembler state
+ * @root:  Root node
+ */
+static int
+cg_emit_bcond(struct arki_state *state, struct ast_node *root)
+{
+    struct symbol *symbol;
+    ssize_t disp = 0;
+    uint8_t opcode;
+    int error;
+
+    if (state == NULL || root == NULL) {
+        return -1;
+    }
+
+    switch (root->type) {
+    case AST_BEQ:
+        opcode = ISA_OPC_BEQ;
+        break;
+    case AST_BNE:
+        opcode = ISA_OPC_BNE;
+        break;
+    case AST_BLT:
+        opcode = ISA_OPC_BLT;
+        break;
+    case AST_BGE:
+        opcode = ISA_OPC_BGE;
+        break;
+    case AST_BLTU:
+        opcode = ISA_OPC_BLTU;
+        break;
+    case AST_BGEU:
+        opcode = ISA_OPC_BGEU;
+        break;
+    default:
+        trace_error(state, "emit bcond root not a branch\n");
+        return -1;
+    }
+
+    symbol = root->symbol;
+    if (symbol != NULL) {
+        disp = (ssize_t)(symbol->vpc - arki_get_vpc(state));
+    }
+
+    /*
+     * Branches are always the same size, so a forward reference
+     * in single-pass mode is simply patched once the label is
+     * known. An object may only branch within itself.
+     */
+    if (symbol == NULL && state->one_pass) {
+        error = fixup_table_add(
+            &state->fixups,
+            FIXUP_REL16,
+            root->name,
+            state->vpc + ISA_DISP_SHIFT / 8,
+            -(ssize_t)arki_get_vpc(state),
+            state->line_num
+        );
+
+        if (error < 0) {
+            trace_error(state, "failed to allocate fixup\n");
+            return -1;
+        }
+    } else if (symbol == NULL && arki_emitting(state)) {
+        trace_error(state, "branch to '%s' outside of this source\n", root->name);
+        return -1;
+    }
+
+    if (arki_emitting(state) && (disp < INT16_MIN || disp > INT16_MAX)) {
+        trace_error(state, "branch to '%s' out of range\n", root->name);
+        return -1;
+    }
+
+    return cg_emit_inst(state, opcode, root->left->reg, root->right->reg, disp);
 }
 
 /*
@@ -444,8 +763,276 @@ cg_emit_skip(struct arki_state *state, struct ast_node *root)
     }
 
     /* Skip a number of bytes */
-    for (uintptr_t i = 0; i < rhs->v; ++i) {
-        cg_emitb(state, 0x00);
+    if (rhs->v <= 0) {
+        return 0;
+    }
+
+    if (arki_emitting(state)) {
+        if (arki_image_fill(state, state->vpc, 0x00, rhs->v) < 0) {
+            trace_error(state, "failed to skip %zd bytes\n", rhs->v);
+            return -1;
+        }
+    }
+
+    state->vpc += rhs->v;
+    return 0;
+}
+
+/*
+ * Emit an align directive, the padding depends on the
+ * address so far and is worked out again on every pass
+ *
+ * @state: Assembler state
+ * @root:  Root node
+ */
+static int
+cg_emit_align(struct arki_state *state, struct ast_node *root)
+{
+    size_t align, pad;
+
+    if (state == NULL || root == NULL) {
+        return -1;
+    }
+
+    if (root->type != AST_ALIGN) {
+        return -1;
+    }
+
+    align = root->right->v;
+    pad = -arki_get_vpc(state) & (align - 1);
+
+    /* The linker must place the section as aligned */
+    if (state->obj && align > state->obj_align) {
+        state->obj_align = align;
+    }
+
+    if (pad == 0) {
+        return 0;
+    }
+
+    if (arki_emitting(state)) {
+        if (arki_image_fill(state, state->vpc, root->left->v, pad) < 0) {
+            trace_error(state, "failed to pad %zu bytes\n", pad);
+            return -1;
+        }
+    }
+
+    state->vpc += pad;
+    return 0;
+}
+
+/*
+ * Resolve the path of an included file, relative paths are
+ * relative to the directory of the including source
+ *
+ * @state: Assembler state
+ * @name:  Path as written in the source
+ * @buf:   Resolved path is written here
+ * @size:  Size of 'buf'
+ *
+ * Returns zero on success
+ */
+static int
+cg_include_path(struct arki_state *state, const char *name, char *buf, size_t size)
+{
+    const char *slash = NULL;
+    int len;
+
+    if (name[0] != '/' && state->in_path != NULL) {
+        slash = strrchr(state->in_path, '/');
+    }
+
+    if (slash == NULL) {
+        len = snprintf(buf, size, "%s", name);
+    } else {
+        len = snprintf(buf, size, "%.*s/%s",
+            (int)(slash - state->in_path), state->in_path, name);
+    }
+
+    if (len < 0 || (size_t)len >= size) {
+        errno = -ENAMETOOLONG;
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Emit an incbin directive
+ *
+ * The blob is sized from the file metadata on every pass
+ * and only read on the emitting pass, straight into the
+ * output image.
+ *
+ * @state: Assembler state
+ * @root:  Root node
+ */
+static int
+cg_emit_incbin(struct arki_state *state, struct ast_node *root)
+{
+    char path[PATH_MAX];
+    struct stat st;
+    ssize_t off, len;
+    uint64_t start;
+    int fd, error = 0;
+
+    if (state == NULL || root == NULL) {
+        return -1;
+    }
+
+    if (root->type != AST_INCBIN) {
+        return -1;
+    }
+
+    if (cg_include_path(state, root->name, path, sizeof(path)) < 0) {
+        trace_error(state, "path of '%s' too long\n", root->name);
+        return -1;
+    }
+
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        trace_error(state, "failed to open '%s'\n", path);
+        return -1;
+    }
+
+    if (fstat(fd, &st) < 0) {
+        trace_error(state, "failed to stat '%s'\n", path);
+        close(fd);
+        return -1;
+    }
+
+    off = root->left->v;
+    len = root->right->v;
+    if (off > st.st_size) {
+        trace_error(state, "offset %zd is past the end of '%s'\n", off, path);
+        close(fd);
+        return -1;
+    }
+
+    if (len < 0) {
+        len = st.st_size - off;
+    }
+
+    if (len > st.st_size - off) {
+        trace_error(state, "'%s' has less than %zd bytes at %zd\n", path, len, off);
+        close(fd);
+        return -1;
+    }
+
+    if (arki_emitting(state) && len > 0) {
+        start = arki_prof_begin(&state->prof);
+        error = arki_image_load(state, state->vpc, fd, off, len);
+        arki_prof_end(&state->prof, ARKI_PROF_IO, start);
+        if (error < 0) {
+            trace_error(state, "failed to read '%s'\n", path);
+        }
+    }
+
+    close(fd);
+    state->vpc += len;
+    return error;
+}
+
+int
+cg_settle_movs(struct arki_state *state)
+{
+    struct fixup *fixup;
+    struct symbol *symbol;
+
+    if (state == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    for (size_t i = 0; i < state->fixups.count; ++i) {
+        fixup = &state->fixups.fixups[i];
+        if (fixup->type != FIXUP_MOVSZ) {
+            continue;
+        }
+
+        symbol = symbol_by_name(&state->symtab, fixup->name);
+        if (symbol == NULL) {
+            state->line_num = fixup->line_num;
+            trace_error(state, "undefined reference to '%s'\n", fixup->name);
+            return -1;
+        }
+
+        if (symbol->vpc > SHORT_IMM_MAX) {
+            state->mov_wide[fixup->off] = 1;
+            state->unsettled = true;
+        }
+    }
+
+    fixup_table_destroy(&state->fixups);
+    return 0;
+}
+
+int
+cg_apply_fixups(struct arki_state *state)
+{
+    struct fixup *fixup;
+    struct symbol *symbol;
+    uint8_t buf[2];
+    ssize_t disp;
+    size_t len;
+
+    if (state == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    for (size_t i = 0; i < state->fixups.count; ++i) {
+        fixup = &state->fixups.fixups[i];
+        switch (fixup->type) {
+        case FIXUP_IMM16:
+            symbol = symbol_by_name(&state->symtab, fixup->name);
+            if (symbol == NULL) {
+                state->line_num = fixup->line_num;
+                trace_error(state, "undefined reference to '%s'\n", fixup->name);
+                return -1;
+            }
+
+            /*
+             * The sizing pass would have laid this out as a short
+             * move, anything that does not fit changes the layout.
+             */
+            if (symbol->vpc > SHORT_IMM_MAX) {
+                return 1;
+            }
+
+            buf[0] = symbol->vpc & 0xFF;
+            buf[1] = (symbol->vpc >> 8) & 0xFF;
+            len = 2;
+            break;
+        case FIXUP_REL16:
+            symbol = symbol_by_name(&state->symtab, fixup->name);
+            if (symbol == NULL) {
+                state->line_num = fixup->line_num;
+                trace_error(state, "undefined reference to '%s'\n", fixup->name);
+                return -1;
+            }
+
+            disp = (ssize_t)symbol->vpc + fixup->addend;
+            if (disp < INT16_MIN || disp > INT16_MAX) {
+                state->line_num = fixup->line_num;
+                trace_error(state, "branch to '%s' out of range\n", fixup->name);
+                return -1;
+            }
+
+            buf[0] = disp & 0xFF;
+            buf[1] = (disp >> 8) & 0xFF;
+            len = 2;
+            break;
+        case FIXUP_SIZE8:
+            buf[0] = state->out_size & 0xFF;
+            len = 1;
+            break;
+        default:
+            return -1;
+        }
+
+        if (arki_image_write(state, fixup->off, buf, len) < 0) {
+            return -1;
+        }
     }
 
     return 0;
@@ -484,7 +1071,11 @@ cg_resolve_node(struct arki_state *state, struct ast_node *root)
 
         return 0;
     case AST_OR:
-        if (cg_emit_or(state, root) < 0) {
+    case AST_ADD:
+    case AST_SUB:
+    case AST_AND:
+    case AST_XOR:
+        if (cg_emit_alu(state, root) < 0) {
             return -1;
         }
 
@@ -496,7 +1087,9 @@ cg_resolve_node(struct arki_state *state, struct ast_node *root)
 
         return 0;
     case AST_BYTE:
-        if (cg_emit_bytes(state, root) < 0) {
+    case AST_WORD:
+    case AST_QUAD:
+        if (cg_emit_data(state, root) < 0) {
             return -1;
         }
 
@@ -506,12 +1099,35 @@ cg_resolve_node(struct arki_state *state, struct ast_node *root)
             return -1;
         }
 
+        return 0;
+    case AST_INCBIN:
+        if (cg_emit_incbin(state, root) < 0) {
+            return -1;
+        }
+
+        return 0;
+    case AST_ALIGN:
+        if (cg_emit_align(state, root) < 0) {
+            return -1;
+        }
+
         return 0;
     case AST_BRANCH:
         if (cg_emit_branch(state, root) < 0) {
             return -1;
         }
 
+        return 0;
+    case AST_BEQ:
+    case AST_BNE:
+    case AST_BLT:
+    case AST_BGE:
+    case AST_BLTU:
+    case AST_BGEU:
+        if (cg_emit_bcond(state, root) < 0) {
+            return -1;
+        }
+
         return 0;
     case AST_STB:
     case AST_STW:
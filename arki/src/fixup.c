@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "arki/fixup.h"
+
+/* Initial fixup vector capacity */
+#define FIXUP_INIT_CAP 64
+
+int
+fixup_table_init(struct fixup_table *table)
+{
+    if (table == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    table->fixups = NULL;
+    table->count = 0;
+    table->cap = 0;
+    return 0;
+}
+
+int
+fixup_table_add(struct fixup_table *table, fixup_type_t type,
+    const char *name, size_t off, ssize_t addend,
+    size_t line_num)
+{
+    struct fixup *fixup, *tmp;
+    size_t cap;
+
+    if (table == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (table->count >= table->cap) {
+        cap = (table->cap == 0) ? FIXUP_INIT_CAP : table->cap * 2;
+        tmp = realloc(table->fixups, cap * sizeof(*tmp));
+        if (tmp == NULL) {
+            errno = -ENOMEM;
+            return -1;
+        }
+
+        table->fixups = tmp;
+        table->cap = cap;
+    }
+
+    fixup = &table->fixups[table->count];
+    fixup->name = NULL;
+    if (name != NULL && (fixup->name = strdup(name)) == NULL) {
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    fixup->type = type;
+    fixup->off = off;
+    fixup->addend = addend;
+    fixup->line_num = line_num;
+    ++table->count;
+    return 0;
+}
+
+void
+fixup_table_destroy(struct fixup_table *table)
+{
+    if (table == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < table->count; ++i) {
+        free(table->fixups[i].name);
+    }
+
+    free(table->fixups);
+    table->fixups = NULL;
+    table->count = 0;
+    table->cap = 0;
+}
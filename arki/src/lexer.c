@@ -10,7 +10,6 @@
 #include <string.h>
 #include <ctype.h>
 #include <errno.h>
-#include <unistd.h>
 #include "arki/lexer.h"
 #include "arki/ptrbox.h"
 #include "arki/trace.h"
@@ -63,15 +62,17 @@ lexer_skip_line(struct arki_state *state)
         return;
     }
 
-    while (read(state->in_fd, &c, 1) > 0) {
+    while (state->in_pos < state->in_len) {
+        c = state->in_buf[state->in_pos++];
         if (c == '\n') {
+            ++state->line_num;
             break;
         }
     }
 }
 
 /*
- * Consume a single byte from the input file
+ * Consume a single byte from the input buffer
  *
  * @state:   Assembler state
  * @skip_ws: If true, skip whitespace characters
@@ -96,7 +97,8 @@ lexer_consume(struct arki_state *state, bool skip_ws)
     }
 
     /* Begin reading bytes and skip whitespace if we can */
-    while (read(state->in_fd, &c, 1) > 0) {
+    while (state->in_pos < state->in_len) {
+        c = state->in_buf[state->in_pos++];
         if (skip_ws && lexer_is_ws(c)) {
             continue;
         }
@@ -107,9 +109,186 @@ lexer_consume(struct arki_state *state, bool skip_ws)
     return '\0';
 }
 
+/* Keyword table entry */
+#define KW(name, type) \
+    { (name), sizeof(name) - 1, (type) }
+
+/* Keyword table size (power-of-two) */
+#define KWTAB_SIZE 128
+
+/*
+ * Keyword hash constants, the smallest multipliers that
+ * put every keyword in its own slot. lexer_kw_check() is
+ * run by 'make check' and fails once a new keyword does
+ * not fit, they must then be searched for again.
+ */
+#define KWHASH_FIRST  7
+#define KWHASH_LAST   62
+#define KWHASH_SECOND 35
+
+/*
+ * Represents a keyword table entry
+ *
+ * @name: Keyword name
+ * @len:  Length of keyword name
+ * @type: Token type of keyword
+ */
+struct keyword {
+    const char *name;
+    size_t len;
+    tt_t type;
+};
+
+/*
+ * Perfect hash table of mnemonics, directives and registers
+ * indexed by lexer_kw_hash()
+ */
+static const struct keyword kwtab[KWTAB_SIZE] = {
+    [  0] = KW("a7",      TT_A7),
+    [  1] = KW("ldq",     TT_LDQ),
+    [  3] = KW("g0",      TT_G0),
+    [  7] = KW("g4",      TT_G4),
+    [ 13] = KW("blt",     TT_BLT),
+    [ 14] = KW("add",     TT_ADD),
+    [ 16] = KW("srw",     TT_SRW),
+    [ 20] = KW("xor",     TT_XOR),
+    [ 23] = KW("sp",      TT_SP),
+    [ 26] = KW(".origin", TT_ORIGIN),
+    [ 27] = KW("a2",      TT_A2),
+    [ 29] = KW("bgeu",    TT_BGEU),
+    [ 31] = KW("a6",      TT_A6),
+    [ 32] = KW(".skip",   TT_SKIP),
+    [ 35] = KW(".byte",   TT_BYTE),
+    [ 38] = KW("g3",      TT_G3),
+    [ 42] = KW("g7",      TT_G7),
+    [ 44] = KW("stl",     TT_STL),
+    [ 47] = KW(".align",  TT_ALIGN),
+    [ 49] = KW("bne",     TT_BNE),
+    [ 55] = KW("hlt",     TT_HLT),
+    [ 58] = KW("a1",      TT_A1),
+    [ 60] = KW("bge",     TT_BGE),
+    [ 61] = KW("or",      TT_OR),
+    [ 62] = KW("a5",      TT_A5),
+    [ 63] = KW("mov",     TT_MOV),
+    [ 64] = KW("stb",     TT_STB),
+    [ 68] = KW(".word",   TT_WORD),
+    [ 69] = KW("g2",      TT_G2),
+    [ 72] = KW(".incbin", TT_INCBIN),
+    [ 73] = KW("g6",      TT_G6),
+    [ 75] = KW("ldl",     TT_LDL),
+    [ 76] = KW("bltu",    TT_BLTU),
+    [ 83] = KW(".balign", TT_BALIGN),
+    [ 86] = KW("stw",     TT_STW),
+    [ 89] = KW("a0",      TT_A0),
+    [ 90] = KW("srr",     TT_SRR),
+    [ 93] = KW("a4",      TT_A4),
+    [ 94] = KW("beq",     TT_BEQ),
+    [ 95] = KW("ldb",     TT_LDB),
+    [ 98] = KW("stq",     TT_STQ),
+    [ 99] = KW("sub",     TT_SUB),
+    [100] = KW("g1",      TT_G1),
+    [104] = KW("g5",      TT_G5),
+    [107] = KW("b",       TT_B),
+    [108] = KW("and",     TT_AND),
+    [111] = KW("litr",    TT_LITR),
+    [114] = KW(".quad",   TT_QUAD),
+    [117] = KW("ldw",     TT_LDW),
+    [124] = KW("a3",      TT_A3),
+};
+
+/*
+ * Hash a keyword candidate into a keyword table slot
+ *
+ * @s:   Start of candidate
+ * @len: Length of candidate (non-zero)
+ */
+static inline size_t
+lexer_kw_hash(const char *s, size_t len)
+{
+    size_t h;
+
+    h = len;
+    h += (uint8_t)s[0] * KWHASH_FIRST;
+    h += (uint8_t)s[len - 1] * KWHASH_LAST;
+    h += (len > 1) ? (uint8_t)s[1] * KWHASH_SECOND : 0;
+    return h & (KWTAB_SIZE - 1);
+}
+
+/*
+ * Look up a keyword in the keyword table
+ *
+ * @s:   Start of candidate
+ * @len: Length of candidate
+ *
+ * Returns the keyword token type on a match, otherwise
+ * TT_IDENT
+ */
+static tt_t
+lexer_kw_lookup(const char *s, size_t len)
+{
+    const struct keyword *kw;
+
+    kw = &kwtab[lexer_kw_hash(s, len)];
+    if (kw->len != len || kw->name == NULL) {
+        return TT_IDENT;
+    }
+
+    if (memcmp(kw->name, s, len) != 0) {
+        return TT_IDENT;
+    }
+
+    return kw->type;
+}
+
+int
+lexer_kw_check(void)
+{
+    const struct keyword *kw;
+    size_t count[TT_KW_LAST + 1] = { 0 };
+    int error = 0;
+
+    for (size_t i = 0; i < KWTAB_SIZE; ++i) {
+        kw = &kwtab[i];
+        if (kw->name == NULL) {
+            continue;
+        }
+
+        if (kw->type < TT_KW_FIRST || kw->type > TT_KW_LAST) {
+            printf("keyword '%s' has a bad token type\n", kw->name);
+            error = -1;
+            continue;
+        }
+
+        if (lexer_kw_hash(kw->name, kw->len) != i) {
+            printf(
+                "keyword '%s' in slot %zu, hashes to %zu\n",
+                kw->name,
+                i,
+                lexer_kw_hash(kw->name, kw->len)
+            );
+            error = -1;
+        }
+
+        ++count[kw->type];
+    }
+
+    /* A colliding entry overrides another one, find those */
+    for (tt_t type = TT_KW_FIRST; type <= TT_KW_LAST; ++type) {
+        if (count[type] != 1) {
+            printf("token type %d has %zu keywords\n", type, count[type]);
+            error = -1;
+        }
+    }
+
+    return error;
+}
+
 /*
  * Scan for a single identifier
  *
+ * The identifier is scanned in place from the input buffer
+ * and only copied out if it is not a keyword.
+ *
  * @state:  Assembler state
  * @lc:     Last character
  * @re:     Token result
@@ -119,8 +298,10 @@ lexer_consume(struct arki_state *state, bool skip_ws)
 static int
 lexer_scan_ident(struct arki_state *state, int lc, struct token *res)
 {
-    char c, *buf;
-    size_t bufcap, bufind;
+    const char *start;
+    size_t len = 1;
+    char *buf;
+    char c;
 
     if (state == NULL || res == NULL) {
         errno = -EINVAL;
@@ -140,242 +321,85 @@ lexer_scan_ident(struct arki_state *state, int lc, struct token *res)
         break;
     }
 
-    /* Set buffer capacity and index */
-    bufcap = 8;
-    bufind = 0;
-
-    if ((buf = malloc(bufcap)) == NULL) {
-        errno = -ENOMEM;
-        return -1;
-    }
-
-    buf[bufind++] = lc;
-    for (;;) {
-        c = lexer_consume(state, false);
+    /*
+     * The last character is always the one right behind
+     * the cursor, whether or not it came from the putback
+     * buffer.
+     */
+    start = &state->in_buf[state->in_pos - 1];
+    while (state->in_pos < state->in_len) {
+        c = state->in_buf[state->in_pos];
         if (!isalnum(c) && c != '_') {
-            buf[bufind] = '\0';
-            if (c != ':') lexer_putback(state, c);
             break;
         }
 
-        /* Fill and resize buffer if needed */
-        buf[bufind++] = c;
-        if (bufind >= bufcap - 1) {
-            bufcap += 8;
-            buf = realloc(buf, bufcap);
-        }
-
-        if (buf == NULL) {
-            errno = -ENOMEM;
-            return -1;
-        }
+        ++state->in_pos;
+        ++len;
     }
 
-    res->type = c != ':' ? TT_IDENT : TT_LABEL;
-    res->s = ptrbox_strdup(&state->ptrbox, buf);
-    free(buf);
-    return 0;
-}
-
-/*
- * Check an indentifier token against a list of  registers and
- * override the type if it matches.
- *
- * @tok:   Token to check
- *
- * Returns zero on success
- */
-static int
-lexer_reg(struct token *tok)
-{
-    uint8_t reg_num;
-    char *p;
-    tt_t *table_ptr = NULL;
-    tt_t areg_lookup[] = {
-        TT_A0,   TT_A1,
-        TT_A2,   TT_A3,
-        TT_A4,   TT_A5,
-        TT_A6,   TT_A7
-    };
-    tt_t greg_lookup[] = {
-        TT_G0,   TT_G1,
-        TT_G2,   TT_G3,
-        TT_G4,   TT_G5,
-        TT_G6,   TT_G7
-    };
-
-    if (tok == NULL) {
-        errno = -EINVAL;
-        return -1;
-    }
-
-    if (tok->type != TT_IDENT) {
-        errno = -EINVAL;
-        return -1;
-    }
-
-    p = tok->s;
-    switch (*(p++))  {
-    case 'g':
-        table_ptr = &greg_lookup[0];
-        break;
-    case 'a':
-        table_ptr = &areg_lookup[0];
-        break;
+    /* Labels end in a colon */
+    if (state->in_pos < state->in_len && state->in_buf[state->in_pos] == ':') {
+        ++state->in_pos;
+        res->type = TT_LABEL;
+    } else if ((res->type = lexer_kw_lookup(start, len)) != TT_IDENT) {
+        return 0;
     }
 
-    /* There are only 7 a/g regs each */
-    reg_num = atoi(p);
-    if (reg_num > 7) {
-        errno = -EINVAL;
+    if ((buf = ptrbox_alloc(&state->ptrbox, len + 1)) == NULL) {
+        errno = -ENOMEM;
         return -1;
     }
 
-    tok->type = table_ptr[reg_num];
+    memcpy(buf, start, len);
+    buf[len] = '\0';
+    res->s = buf;
     return 0;
 }
 
 /*
- * Check if a token is actually a keyword and overwrite it if
- * so
+ * Scan for a string token, the opening quote has already
+ * been consumed. Strings may not span lines.
  *
- * @tok: Token to check
+ * @state:  Assembler state
+ * @res:    Token result
  *
- * Returns zero on successful overwrite
+ * Returns zero on success
  */
 static int
-lexer_check_kw(struct token *tok)
+lexer_scan_string(struct arki_state *state, struct token *res)
 {
-    if (tok == NULL) {
-        errno = -EINVAL;
-        return -1;
-    }
-
-    if (tok->type != TT_IDENT) {
-        errno = -EINVAL;
-        return -1;
-    }
-
-    switch (*tok->s) {
-    case 'm':
-        if (strcmp(tok->s, "mov") == 0) {
-            tok->type = TT_MOV;
-            return 0;
-        }
-
-        break;
-    case 'h':
-        if (strcmp(tok->s, "hlt") == 0) {
-            tok->type = TT_HLT;
-            return 0;
-        }
-
-        break;
-    case 's':
-        if (strcmp(tok->s, "sp") == 0) {
-            tok->type = TT_SP;
-            return 0;
-        }
-
-        if (strcmp(tok->s, "srr") == 0) {
-            tok->type = TT_SRR;
-            return 0;
-        }
-
-        if (strcmp(tok->s, "srw") == 0) {
-            tok->type = TT_SRW;
-            return 0;
-        }
-
-        if (strcmp(tok->s, "stb") == 0) {
-            tok->type = TT_STB;
-            return 0;
-        }
-
-        if (strcmp(tok->s, "stw") == 0) {
-            tok->type = TT_STW;
-            return 0;
-        }
-
-        if (strcmp(tok->s, "stl") == 0) {
-            tok->type = TT_STL;
-            return 0;
-        }
-
-        if (strcmp(tok->s, "stq") == 0) {
-            tok->type = TT_STQ;
-            return 0;
-        }
-
-        break;
-    case 'o':
-        if (strcmp(tok->s, "or") == 0) {
-            tok->type = TT_OR;
-            return 0;
-        }
-
-        break;
-    case 'l':
-        if (strcmp(tok->s, "litr") == 0) {
-            tok->type = TT_LITR;
-            return 0;
-        }
-
-        if (strcmp(tok->s, "ldb") == 0) {
-            tok->type = TT_LDB;
-            return 0;
-        }
-
-        if (strcmp(tok->s, "ldw") == 0) {
-            tok->type = TT_LDW;
-            return 0;
-        }
-
-        if (strcmp(tok->s, "ldl") == 0) {
-            tok->type = TT_LDL;
-            return 0;
-        }
-
-        if (strcmp(tok->s, "ldq") == 0) {
-            tok->type = TT_LDQ;
-            return 0;
-        }
-
-        break;
-    case '.':
-        if (strcmp(tok->s, ".byte") == 0) {
-            tok->type = TT_BYTE;
-            return 0;
-        }
-
-        if (strcmp(tok->s, ".skip") == 0) {
-            tok->type = TT_SKIP;
-            return 0;
-        }
+    const char *start;
+    size_t len = 0;
+    char *buf;
+    char c;
 
-        if (strcmp(tok->s, ".origin") == 0) {
-            tok->type = TT_ORIGIN;
-            return 0;
+    start = &state->in_buf[state->in_pos];
+    while (state->in_pos < state->in_len) {
+        c = state->in_buf[state->in_pos];
+        if (c == '"' || c == '\n') {
+            break;
         }
 
-        break;
-    case 'b':
-        if (strcmp(tok->s, "b") == 0) {
-            tok->type = TT_B;
-            return 0;
-        }
+        ++state->in_pos;
+        ++len;
+    }
 
-        break;
-    case 'g':
-    case 'a':
-        if (lexer_reg(tok) == 0) {
-            return 0;
-        }
+    if (state->in_pos >= state->in_len || state->in_buf[state->in_pos] != '"') {
+        trace_error(state, "unterminated string\n");
+        return -1;
+    }
 
-        break;
+    ++state->in_pos;
+    if ((buf = ptrbox_alloc(&state->ptrbox, len + 1)) == NULL) {
+        errno = -ENOMEM;
+        return -1;
     }
 
-    return -1;
+    memcpy(buf, start, len);
+    buf[len] = '\0';
+    res->type = TT_STRING;
+    res->s = buf;
+    return 0;
 }
 
 /*
@@ -415,6 +439,12 @@ lexer_scan_number(struct arki_state *state, int lc, struct token *res)
         if (c == 'x') {
             base = 16;
             c = lexer_consume(state, false);
+        } else if (!isdigit(c)) {
+            /* Just a zero, leave what follows it alone */
+            lexer_putback(state, c);
+            res->type = TT_NUMBER;
+            res->v = 0;
+            return 0;
         }
     }
 
@@ -447,11 +477,265 @@ lexer_scan_number(struct arki_state *state, int lc, struct token *res)
         }
     }
 
+    /* Wrap rather than clamp so all 64 bits can be given */
     res->type = TT_NUMBER;
-    res->v = strtol(buf, NULL, base);
+    res->v = strtoull(buf, NULL, base);
     return 0;
 }
 
+/* Bytes handled at once by the SWAR helpers */
+#define SWAR_SIZE 8
+
+/* A byte repeated across every byte of a word */
+#define SWAR_REP(b) ((uint64_t)(b) * 0x0101010101010101ULL)
+
+/* High bit of every byte of a word */
+#define SWAR_HIGH SWAR_REP(0x80)
+
+/*
+ * Most digits of a list number that convert exactly, longer
+ * numbers are left to lexer_scan_number()
+ */
+#define DATA_DEC_MAX 18
+#define DATA_HEX_MAX 16
+
+/*
+ * Load eight input bytes into a word, the first byte in
+ * the low bits
+ *
+ * @p: Input bytes
+ */
+static inline uint64_t
+lexer_swar_load(const char *p)
+{
+    uint64_t x;
+
+    memcpy(&x, p, sizeof(x));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    x = __builtin_bswap64(x);
+#endif
+    return x;
+}
+
+/*
+ * Returns the high bit of every byte of a word that lies
+ * within [lo, hi], every byte must be below 0x80 so that
+ * the sums cannot carry into the next byte
+ *
+ * @x:  Word to test
+ * @lo: Lowest byte in range
+ * @hi: Highest byte in range
+ */
+static inline uint64_t
+lexer_swar_range(uint64_t x, uint8_t lo, uint8_t hi)
+{
+    return (x + SWAR_REP(0x80 - lo)) & ~(x + SWAR_REP(0x7F - hi)) & SWAR_HIGH;
+}
+
+/*
+ * Returns the number of leading bytes of a word flagged in
+ * a mask from lexer_swar_range()
+ *
+ * @mask: High bit of every flagged byte
+ */
+static inline size_t
+lexer_swar_count(uint64_t mask)
+{
+    if (mask == SWAR_HIGH) {
+        return SWAR_SIZE;
+    }
+
+    return __builtin_ctzll(~mask & SWAR_HIGH) / 8;
+}
+
+/*
+ * Convert up to eight decimal digits at once. The digits
+ * are shifted up so that the bytes past them read as
+ * leading zeros, then pairs of digits are folded together,
+ * then pairs of pairs and so on.
+ *
+ * @p:   Input bytes, eight must be readable
+ * @res: Value is written here
+ *
+ * Returns the number of digits converted
+ */
+static inline size_t
+lexer_swar_dec(const char *p, uint64_t *res)
+{
+    uint64_t x;
+    size_t n;
+
+    /* Bytes with the high bit set are never digits */
+    x = lexer_swar_load(p);
+    n = lexer_swar_count(lexer_swar_range(x & ~SWAR_HIGH, '0', '9') & ~x);
+    if (n == 0) {
+        return 0;
+    }
+
+    x = (x - SWAR_REP('0')) << ((SWAR_SIZE - n) * 8);
+    x = (x * 10 + (x >> 8)) & 0x00FF00FF00FF00FFULL;
+    x = (x * 100 + (x >> 16)) & 0x0000FFFF0000FFFFULL;
+    x = (x * 10000 + (x >> 32)) & 0x00000000FFFFFFFFULL;
+    *res = x;
+    return n;
+}
+
+/*
+ * Convert up to eight hexadecimal digits at once
+ *
+ * @p:   Input bytes, eight must be readable
+ * @res: Value is written here
+ *
+ * Returns the number of digits converted
+ */
+static inline size_t
+lexer_swar_hex(const char *p, uint64_t *res)
+{
+    uint64_t x, y, digit, alpha;
+    size_t n;
+
+    /* Setting 0x20 folds case, only letters are tested folded */
+    x = lexer_swar_load(p);
+    y = x & ~SWAR_HIGH;
+    digit = lexer_swar_range(y, '0', '9');
+    alpha = lexer_swar_range(y | SWAR_REP(0x20), 'a', 'f');
+    if ((n = lexer_swar_count((digit | alpha) & ~x)) == 0) {
+        return 0;
+    }
+
+    /* Letters have bit 6 set and a low nibble nine short */
+    x = (x & SWAR_REP(0x0F)) + ((x >> 6) & SWAR_REP(0x01)) * 9;
+    x <<= (SWAR_SIZE - n) * 8;
+    x = ((x << 4) & 0x00F000F000F000F0ULL) | ((x >> 8) & 0x000F000F000F000FULL);
+    x = ((x << 8) & 0x0000FF000000FF00ULL) | ((x >> 16) & 0x000000FF000000FFULL);
+    x = ((x << 16) & 0x00000000FFFF0000ULL) | ((x >> 32) & 0x000000000000FFFFULL);
+    *res = x;
+    return n;
+}
+
+/*
+ * Scan a plain number for lexer_scan_data(), up to eight
+ * digits at a time while the input allows it. Anything
+ * unusual is turned down so lexer_scan_number() gets to
+ * decide.
+ *
+ * @p:   Start of number
+ * @end: End of input
+ * @res: Value is written here
+ *
+ * Returns the end of the number, or NULL if it is not a
+ * plain number
+ */
+static const char *
+lexer_data_number(const char *p, const char *end, uint64_t *res)
+{
+    static const uint64_t pow10[SWAR_SIZE + 1] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+    };
+    size_t n, digits = 0, max = DATA_DEC_MAX;
+    uint64_t v = 0, chunk;
+    bool hex = false;
+    uint8_t c;
+
+    if (p >= end || !isdigit((uint8_t)*p)) {
+        return NULL;
+    }
+
+    if (*p == '0') {
+        if (++p < end && *p == 'x') {
+            if (++p >= end || !isxdigit((uint8_t)*p)) {
+                return NULL;
+            }
+
+            max = DATA_HEX_MAX;
+            hex = true;
+        } else if (p >= end || !isdigit((uint8_t)*p)) {
+            *res = 0;
+            return p;
+        }
+    }
+
+    while (p < end) {
+        if ((end - p) >= SWAR_SIZE) {
+            n = hex ? lexer_swar_hex(p, &chunk) : lexer_swar_dec(p, &chunk);
+        } else if (hex ? isxdigit((uint8_t)*p) : isdigit((uint8_t)*p)) {
+            c = *p;
+            chunk = isdigit(c) ? c - '0' : (c | 0x20) - 'a' + 10;
+            n = 1;
+        } else {
+            n = 0;
+        }
+
+        if (n == 0) {
+            if (*p != '_') {
+                break;
+            }
+
+            ++p;
+            continue;
+        }
+
+        if ((digits += n) > max) {
+            return NULL;
+        }
+
+        v = hex ? (v << (n * 4)) | chunk : v * pow10[n] + chunk;
+        p += n;
+    }
+
+    *res = v;
+    return p;
+}
+
+size_t
+lexer_scan_data(struct arki_state *state, size_t width, uint8_t *buf, size_t cap,
+    bool *more)
+{
+    const char *p, *end, *next;
+    size_t count = 0;
+    uint64_t v;
+
+    *more = true;
+
+    /* The lexer is holding a character back, let it go first */
+    if (state->putback != '\0') {
+        return 0;
+    }
+
+    p = &state->in_buf[state->in_pos];
+    end = &state->in_buf[state->in_len];
+    while (count < cap) {
+        while (p < end && lexer_is_ws(*p)) {
+            ++p;
+        }
+
+        if ((next = lexer_data_number(p, end, &v)) == NULL) {
+            break;
+        }
+
+        for (size_t i = 0; i < width; ++i) {
+            buf[count * width + i] = (v >> (i * 8)) & 0xFF;
+        }
+
+        ++count;
+        p = next;
+        while (p < end && lexer_is_ws(*p)) {
+            ++p;
+        }
+
+        /* Whatever ends the list is scanned as a token */
+        if (p >= end || *p != ',') {
+            *more = false;
+            break;
+        }
+
+        ++p;
+    }
+
+    state->in_pos = p - state->in_buf;
+    return count;
+}
+
 int
 lexer_scan(struct arki_state *state, struct token *res)
 {
@@ -479,6 +763,8 @@ lexer_scan(struct arki_state *state, struct token *res)
         res->type = TT_NEWLINE;
         res->c = c;
         return 0;
+    case '"':
+        return lexer_scan_string(state, res);
     case ';':
         lexer_skip_line(state);
         res->type = TT_COMMENT;
@@ -486,7 +772,6 @@ lexer_scan(struct arki_state *state, struct token *res)
         return 0;
     default:
         if (lexer_scan_ident(state, c, res) == 0) {
-            lexer_check_kw(res);
             return 0;
         }
 
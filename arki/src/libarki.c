@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include "arki/libarki.h"
+#include "arki/state.h"
+#include "arki/trace.h"
+#include "arki/parser.h"
+#include "arki/codegen.h"
+#include "arki/obj.h"
+#include "arki/map.h"
+
+/*
+ * Assemble in a single pass, backpatching forward references
+ * once their labels are defined.
+ *
+ * @state: Assembler state
+ *
+ * Returns zero on success, one if the source must be
+ * assembled in two passes instead
+ */
+static int
+arki_one_pass(struct arki_state *state)
+{
+    int error;
+
+    state->one_pass = true;
+    if (arki_parse(state) < 0) {
+        return -1;
+    }
+
+    if ((error = cg_apply_fixups(state)) != 0) {
+        return error;
+    }
+
+    return 0;
+}
+
+/*
+ * Make every pass needed over the source
+ *
+ * @state: Assembler state
+ * @opts:  Assembly options
+ *
+ * Returns zero on success
+ */
+static int
+arki_passes(struct arki_state *state, const struct arki_options *opts)
+{
+    int error;
+
+    if (opts->one_pass && !opts->obj) {
+        if ((error = arki_one_pass(state)) <= 0) {
+            return error;
+        }
+
+        /* Layout depends on forward references, do it twice */
+        state->one_pass = false;
+        if (arki_state_rewind(state) < 0) {
+            return -1;
+        }
+    }
+
+    /* Sizing passes repeat until the layout settles */
+    while (state->pass_count < PASS_COUNT) {
+        if (arki_parse(state) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Copy the labels of an assembled source into a result,
+ * names are stored right after the labels themselves
+ *
+ * @state: Assembler state
+ * @res:   Result to fill in
+ *
+ * Returns zero on success
+ */
+static int
+arki_collect_syms(struct arki_state *state, struct arki_result *res)
+{
+    struct symbol *sym;
+    size_t count = 0, size = 0, len;
+    char *names;
+
+    for (size_t i = 0; i < state->symtab.sym_count; ++i) {
+        sym = symbol_by_id(&state->symtab, i);
+        if (sym->type == SYMBOL_LABEL) {
+            size += sizeof(struct arki_sym) + strlen(sym->name) + 1;
+            ++count;
+        }
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+
+    if ((res->syms = malloc(size)) == NULL) {
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    names = (char *)&res->syms[count];
+    for (size_t i = 0; i < state->symtab.sym_count; ++i) {
+        sym = symbol_by_id(&state->symtab, i);
+        if (sym->type != SYMBOL_LABEL) {
+            continue;
+        }
+
+        len = strlen(sym->name) + 1;
+        memcpy(names, sym->name, len);
+        res->syms[res->sym_count].name = names;
+        res->syms[res->sym_count++].addr = sym->vpc;
+        names += len;
+    }
+
+    return 0;
+}
+
+/*
+ * Gather everything asked for out of an assembled source
+ *
+ * @state: Assembler state
+ * @opts:  Assembly options
+ * @res:   Result to fill in
+ *
+ * Returns zero on success
+ */
+static int
+arki_collect(struct arki_state *state, const struct arki_options *opts,
+    struct arki_result *res)
+{
+    FILE *fp;
+    int error;
+
+    if (arki_collect_syms(state, res) < 0) {
+        return -1;
+    }
+
+    if (opts->map && map_encode(state, &res->map, &res->map_len) < 0) {
+        return -1;
+    }
+
+    if (opts->listing) {
+        if ((fp = open_memstream(&res->listing, &res->listing_len)) == NULL) {
+            return -1;
+        }
+
+        error = list_write(state, fp);
+        if (fclose(fp) != 0 || error < 0) {
+            return -1;
+        }
+    }
+
+    if (opts->obj) {
+        return obj_encode(state, &res->image, &res->image_len);
+    }
+
+    /* Already written out save for the window */
+    if (opts->stream) {
+        if (arki_image_flush(state) < 0) {
+            return -1;
+        }
+
+        res->image_len = state->out_len;
+        return ftruncate(opts->stream_fd, state->out_len);
+    }
+
+    /* The image is handed over as is */
+    res->image = state->out_buf;
+    res->image_len = state->out_len;
+    state->out_buf = NULL;
+    state->out_cap = 0;
+    state->out_len = 0;
+    return 0;
+}
+
+/*
+ * Hand the timing report over to a result, along with the
+ * figures only known at the end
+ *
+ * @state: Assembler state
+ * @start: Time the assembly started at
+ * @res:   Result to fill in
+ *
+ * Returns zero on success
+ */
+static int
+arki_collect_prof(struct arki_state *state, uint64_t start, struct arki_result *res)
+{
+    struct arki_prof *prof = &state->prof;
+
+    prof->total_ns += arki_prof_now() - start;
+    prof->symbols = state->symtab.sym_count;
+    prof->ptrbox_peak = state->ptrbox.bytes_peak;
+    if ((res->prof = malloc(sizeof(*res->prof))) == NULL) {
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    memcpy(res->prof, prof, sizeof(*prof));
+    return 0;
+}
+
+/*
+ * Set up streamed output if asked for, only a flat image
+ * is made in order
+ *
+ * @state: Assembler state
+ * @opts:  Assembly options
+ *
+ * Returns zero on success
+ */
+static int
+arki_stream_setup(struct arki_state *state, const struct arki_options *opts)
+{
+    if (!opts->stream) {
+        return 0;
+    }
+
+    /* Both need the whole image at hand */
+    if (opts->obj || opts->listing) {
+        arki_diag(state, "[error]: cannot stream %s\n", opts->obj ? "objects" : "with a listing");
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (ftruncate(opts->stream_fd, 0) < 0) {
+        return -1;
+    }
+
+    return arki_state_stream(state, opts->stream_fd);
+}
+
+/*
+ * Assemble an initialized state and tear it down
+ *
+ * @state: Assembler state
+ * @opts:  Assembly options, NULL for defaults
+ * @res:   Result to fill in
+ *
+ * Returns zero on success
+ */
+static int
+arki_run(struct arki_state *state, const struct arki_options *opts,
+    struct arki_result *res)
+{
+    static const struct arki_options defaults = {0};
+    uint64_t start;
+    int error;
+
+    if (opts == NULL) {
+        opts = &defaults;
+    }
+
+    state->prof.enabled = opts->prof;
+    start = state->prof.enabled ? arki_prof_now() : 0;
+
+    state->obj = opts->obj;
+    state->listing.enabled = opts->listing;
+    if ((error = arki_stream_setup(state, opts)) == 0) {
+        error = arki_passes(state, opts);
+    }
+
+    if (error == 0) {
+        error = arki_collect(state, opts, res);
+    }
+
+    if (error == 0 && opts->prof) {
+        error = arki_collect_prof(state, start, res);
+    }
+
+    res->diag = state->diag;
+    res->diag_len = state->diag_len;
+    state->diag = NULL;
+    arki_state_close(state);
+    return error;
+}
+
+int
+arki_assemble(const char *src, size_t len, const struct arki_options *opts,
+    struct arki_result *res)
+{
+    struct arki_state state;
+
+    if (res == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    memset(res, 0, sizeof(*res));
+    if (arki_state_init_buf(&state, src, len) < 0) {
+        return -1;
+    }
+
+    return arki_run(&state, opts, res);
+}
+
+int
+arki_assemble_file(const char *path, const struct arki_options *opts,
+    struct arki_result *res)
+{
+    struct arki_state state;
+    uint64_t start;
+
+    if (res == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    memset(res, 0, sizeof(*res));
+    start = (opts != NULL && opts->prof) ? arki_prof_now() : 0;
+    if (arki_state_init(&state, path) < 0) {
+        return -1;
+    }
+
+    /* Reading in the source is the first of the file I/O */
+    if (start != 0) {
+        state.prof.io.ns = arki_prof_now() - start;
+        state.prof.io.calls = 1;
+        state.prof.total_ns = state.prof.io.ns;
+    }
+
+    return arki_run(&state, opts, res);
+}
+
+void
+arki_result_free(struct arki_result *res)
+{
+    if (res == NULL) {
+        return;
+    }
+
+    free(res->image);
+    free(res->syms);
+    free(res->map);
+    free(res->listing);
+    free(res->diag);
+    free(res->prof);
+    memset(res, 0, sizeof(*res));
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <errno.h>
+#include "arki/list.h"
+#include "arki/state.h"
+
+/* Bytes shown per listing row */
+#define LIST_ROW_BYTES 8
+
+/* Bytes shown per line before eliding the rest */
+#define LIST_MAX_BYTES 32
+
+/*
+ * Close the last line of a listing
+ *
+ * @state: Assembler state
+ */
+static void
+list_close(struct arki_state *state)
+{
+    struct arki_listing *list = &state->listing;
+    struct list_line *line;
+
+    if (list->count == 0) {
+        return;
+    }
+
+    line = &list->lines[list->count - 1];
+    line->len = state->vpc - line->vpc;
+}
+
+int
+list_stmt(struct arki_state *state, tt_t type)
+{
+    struct arki_listing *list;
+    struct list_line *line, *tmp;
+    size_t pos, cap;
+
+    if (state == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    list = &state->listing;
+    if (!list->enabled || !arki_emitting(state)) {
+        return 0;
+    }
+
+    if (type == TT_NEWLINE || type == TT_COMMENT) {
+        return 0;
+    }
+
+    /* Several statements may share a line */
+    if (list->count > 0) {
+        if (list->lines[list->count - 1].line_num == state->line_num) {
+            return 0;
+        }
+    }
+
+    list_close(state);
+    if (list->count >= list->cap) {
+        cap = (list->cap == 0) ? 256 : list->cap * 2;
+        if ((tmp = realloc(list->lines, cap * sizeof(*tmp))) == NULL) {
+            errno = -ENOMEM;
+            return -1;
+        }
+
+        list->lines = tmp;
+        list->cap = cap;
+    }
+
+    /* The first token was just scanned, find its line */
+    pos = (state->in_pos > 0) ? state->in_pos - 1 : 0;
+    while (pos > 0 && state->in_buf[pos - 1] != '\n') {
+        --pos;
+    }
+
+    line = &list->lines[list->count++];
+    line->addr = arki_get_vpc(state);
+    line->vpc = state->vpc;
+    line->len = 0;
+    line->pos = pos;
+    line->line_num = state->line_num;
+    return 0;
+}
+
+void
+list_end(struct arki_state *state)
+{
+    if (state == NULL || !state->listing.enabled) {
+        return;
+    }
+
+    if (arki_emitting(state)) {
+        list_close(state);
+    }
+}
+
+int
+list_write(struct arki_state *state, FILE *fp)
+{
+    struct list_line *line;
+    size_t end, col;
+
+    if (state == NULL || fp == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    for (size_t i = 0; i < state->listing.count; ++i) {
+        line = &state->listing.lines[i];
+        fprintf(fp, "%08" PRIXPTR "  ", line->addr);
+
+        for (col = 0; col < LIST_ROW_BYTES; ++col) {
+            if (col < line->len && (line->vpc + col) < state->out_len) {
+                fprintf(fp, "%02X ", state->out_buf[line->vpc + col]);
+            } else {
+                fprintf(fp, "   ");
+            }
+        }
+
+        /* Source line as written */
+        fprintf(fp, " ");
+        for (end = line->pos; end < state->in_len; ++end) {
+            if (state->in_buf[end] == '\n') {
+                break;
+            }
+
+            fputc(state->in_buf[end], fp);
+        }
+
+        fputc('\n', fp);
+
+        /* Bytes that did not fit in the first row */
+        for (col = LIST_ROW_BYTES; col < line->len; ++col) {
+            if (col >= LIST_MAX_BYTES) {
+                fprintf(fp, "%08" PRIXPTR "  ...\n", line->addr + col);
+                break;
+            }
+
+            if ((col % LIST_ROW_BYTES) == 0) {
+                fprintf(fp, "%08" PRIXPTR "  ", line->addr + col);
+            }
+
+            fprintf(fp, "%02X ", state->out_buf[line->vpc + col]);
+            if ((col % LIST_ROW_BYTES) == LIST_ROW_BYTES - 1 || col == line->len - 1) {
+                fputc('\n', fp);
+            }
+        }
+    }
+
+    return ferror(fp) ? -1 : 0;
+}
+
+void
+list_destroy(struct arki_listing *list)
+{
+    if (list == NULL) {
+        return;
+    }
+
+    free(list->lines);
+    list->lines = NULL;
+    list->count = 0;
+    list->cap = 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "arki/map.h"
+#include "arki/state.h"
+
+/*
+ * Compare two symbols by address, then by order of
+ * definition
+ */
+static int
+map_sym_cmp(const void *a, const void *b)
+{
+    const struct symbol *sa = *(struct symbol *const *)a;
+    const struct symbol *sb = *(struct symbol *const *)b;
+
+    if (sa->vpc != sb->vpc) {
+        return (sa->vpc < sb->vpc) ? -1 : 1;
+    }
+
+    return (sa->id < sb->id) ? -1 : (sa->id > sb->id);
+}
+
+int
+map_encode(struct arki_state *state, uint8_t **res, size_t *len)
+{
+    struct symbol **syms;
+    struct map_sym *msyms;
+    struct map_hdr *hdr;
+    size_t count, str_size = 0;
+    uintptr_t next;
+    uint8_t *buf;
+    char *strtab;
+
+    if (state == NULL || res == NULL || len == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    count = state->symtab.sym_count;
+    if ((syms = calloc(count + 1, sizeof(*syms))) == NULL) {
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        syms[i] = symbol_by_id(&state->symtab, i);
+        str_size += strlen(syms[i]->name) + 1;
+    }
+
+    *len = sizeof(*hdr) + count * sizeof(*msyms) + str_size;
+    if ((buf = calloc(1, *len)) == NULL) {
+        free(syms);
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    hdr = (struct map_hdr *)buf;
+    msyms = (struct map_sym *)&buf[sizeof(*hdr)];
+    strtab = (char *)&msyms[count];
+
+    memcpy(hdr->magic, MAP_MAGIC, sizeof(hdr->magic));
+    hdr->version = MAP_VERSION;
+    hdr->sym_count = count;
+    hdr->str_size = str_size;
+
+    /* A symbol spans up to the next address or the image end */
+    qsort(syms, count, sizeof(*syms), map_sym_cmp);
+    next = state->end_addr;
+
+    for (size_t i = count; i-- > 0;) {
+        if (i + 1 < count && syms[i + 1]->vpc != syms[i]->vpc) {
+            next = syms[i + 1]->vpc;
+        }
+
+        msyms[i].addr = syms[i]->vpc;
+        msyms[i].size = (next > syms[i]->vpc) ? next - syms[i]->vpc : 0;
+    }
+
+    str_size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        msyms[i].name = str_size;
+        memcpy(&strtab[str_size], syms[i]->name, strlen(syms[i]->name) + 1);
+        str_size += strlen(syms[i]->name) + 1;
+    }
+
+    free(syms);
+    *res = buf;
+    return 0;
+}
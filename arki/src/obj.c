@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "arki/obj.h"
+#include "arki/state.h"
+#include "arki/trace.h"
+
+/* Name of the one section arki emits */
+#define OBJ_TEXT_NAME ".text"
+
+/*
+ * Represents an object file being built in memory
+ *
+ * @buf: Object file contents
+ * @len: Bytes of object file in use
+ * @cap: Capacity of object file buffer
+ */
+struct obj_buf {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+};
+
+/*
+ * Append bytes to an object file buffer
+ *
+ * @ob:  Object file buffer
+ * @p:   Bytes to append
+ * @n:   Number of bytes to append
+ *
+ * Returns zero on success
+ */
+static int
+obj_append(struct obj_buf *ob, const void *p, size_t n)
+{
+    uint8_t *tmp;
+    size_t cap;
+
+    if (n == 0) {
+        return 0;
+    }
+
+    if ((ob->len + n) > ob->cap) {
+        cap = (ob->cap == 0) ? 4096 : ob->cap;
+        while (cap < (ob->len + n)) {
+            cap *= 2;
+        }
+
+        if ((tmp = realloc(ob->buf, cap)) == NULL) {
+            errno = -ENOMEM;
+            return -1;
+        }
+
+        ob->buf = tmp;
+        ob->cap = cap;
+    }
+
+    memcpy(&ob->buf[ob->len], p, n);
+    ob->len += n;
+    return 0;
+}
+
+/*
+ * Make sure every symbol a relocation refers to exists in
+ * the symbol table, creating undefined ones for externals.
+ *
+ * @state: Assembler state
+ *
+ * Returns zero on success
+ */
+static int
+obj_add_externs(struct arki_state *state)
+{
+    struct fixup *fixup;
+    struct symbol *sym;
+
+    for (size_t i = 0; i < state->fixups.count; ++i) {
+        fixup = &state->fixups.fixups[i];
+        if (fixup->type != FIXUP_IMM48) {
+            continue;
+        }
+
+        if (symbol_by_name(&state->symtab, fixup->name) != NULL) {
+            continue;
+        }
+
+        if (symbol_table_new(&state->symtab, fixup->name, SYMBOL_NONE, &sym) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Build an object file in memory
+ *
+ * @state:     Assembler state
+ * @sym_index: Object symbol index of each symbol ID
+ * @strtab:    String table buffer
+ * @ob:        Object file buffer
+ *
+ * Returns zero on success
+ */
+static int
+obj_build(struct arki_state *state, uint32_t *sym_index,
+    struct obj_buf *strtab, struct obj_buf *ob)
+{
+    struct symbol_table *symtab = &state->symtab;
+    struct obj_hdr hdr;
+    struct obj_sect sect;
+    struct obj_sym osym;
+    struct obj_reloc reloc;
+    struct fixup *fixup;
+    struct symbol *sym;
+    size_t sym_count = 0;
+
+    if (obj_append(strtab, OBJ_TEXT_NAME, sizeof(OBJ_TEXT_NAME)) < 0) {
+        return -1;
+    }
+
+    /*
+     * Only the first definition of a name is exported, as
+     * that is the one references within the file resolve to.
+     */
+    for (size_t i = 0; i < symtab->sym_count; ++i) {
+        sym = symbol_by_id(symtab, i);
+        if (symbol_by_name(symtab, sym->name) != sym) {
+            sym_index[i] = OBJ_SYM_NONE;
+            continue;
+        }
+
+        sym_index[i] = sym_count++;
+        if (obj_append(strtab, sym->name, strlen(sym->name) + 1) < 0) {
+            return -1;
+        }
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, OBJ_MAGIC, sizeof(hdr.magic));
+    hdr.version = OBJ_VERSION;
+    hdr.flags = state->obj_origin_set ? OBJ_F_ORIGIN : 0;
+    hdr.origin = state->obj_origin;
+    hdr.sect_count = 1;
+    hdr.sect_off = sizeof(hdr);
+    hdr.sym_count = sym_count;
+    hdr.sym_off = hdr.sect_off + sizeof(sect);
+    hdr.reloc_count = state->fixups.count;
+    hdr.reloc_off = hdr.sym_off + sym_count * sizeof(osym);
+    hdr.str_size = strtab->len;
+    hdr.str_off = hdr.reloc_off + hdr.reloc_count * sizeof(reloc);
+    if (obj_append(ob, &hdr, sizeof(hdr)) < 0) {
+        return -1;
+    }
+
+    sect.name = 0;
+    sect.align = (state->obj_align > 1) ? state->obj_align : 1;
+    sect.off = hdr.str_off + hdr.str_size;
+    sect.size = state->out_len;
+    if (obj_append(ob, &sect, sizeof(sect)) < 0) {
+        return -1;
+    }
+
+    osym.name = sizeof(OBJ_TEXT_NAME);
+    for (size_t i = 0; i < symtab->sym_count; ++i) {
+        if (sym_index[i] == OBJ_SYM_NONE) {
+            continue;
+        }
+
+        sym = symbol_by_id(symtab, i);
+        osym.sect = (sym->type == SYMBOL_LABEL) ? 0 : OBJ_SECT_UNDEF;
+        osym.value = (sym->type == SYMBOL_LABEL) ? sym->vpc : 0;
+        if (obj_append(ob, &osym, sizeof(osym)) < 0) {
+            return -1;
+        }
+
+        osym.name += strlen(sym->name) + 1;
+    }
+
+    for (size_t i = 0; i < state->fixups.count; ++i) {
+        fixup = &state->fixups.fixups[i];
+        reloc.sect = 0;
+        reloc.off = fixup->off;
+        reloc.sym = OBJ_SYM_NONE;
+
+        switch (fixup->type) {
+        case FIXUP_IMM48:
+            sym = symbol_by_name(symtab, fixup->name);
+            reloc.type = OBJ_RELOC_IMM48;
+            reloc.sym = sym_index[sym->id];
+            break;
+        case FIXUP_SIZE8:
+            reloc.type = OBJ_RELOC_SIZE8;
+            break;
+        default:
+            trace_error(state, "bad fixup type %d\n", fixup->type);
+            return -1;
+        }
+
+        if (obj_append(ob, &reloc, sizeof(reloc)) < 0) {
+            return -1;
+        }
+    }
+
+    if (obj_append(ob, strtab->buf, strtab->len) < 0) {
+        return -1;
+    }
+
+    return obj_append(ob, state->out_buf, state->out_len);
+}
+
+int
+obj_encode(struct arki_state *state, uint8_t **res, size_t *len)
+{
+    struct obj_buf strtab = {0}, ob = {0};
+    uint32_t *sym_index;
+    int error;
+
+    if (state == NULL || res == NULL || len == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (obj_add_externs(state) < 0) {
+        trace_error(state, "failed to add external symbols\n");
+        return -1;
+    }
+
+    sym_index = calloc(state->symtab.sym_count + 1, sizeof(*sym_index));
+    if (sym_index == NULL) {
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    error = obj_build(state, sym_index, &strtab, &ob);
+    free(sym_index);
+    free(strtab.buf);
+    if (error < 0) {
+        free(ob.buf);
+        return -1;
+    }
+
+    *res = ob.buf;
+    *len = ob.len;
+    return 0;
+}
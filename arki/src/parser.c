@@ -5,13 +5,20 @@
 
 #include <stdio.h>
 #include <stdint.h>
-#include <unistd.h>
+#include <string.h>
 #include "arki/parser.h"
 #include "arki/token.h"
 #include "arki/lexer.h"
 #include "arki/trace.h"
 #include "arki/codegen.h"
 #include "arki/reg.h"
+#include "arki/ptrbox.h"
+
+/* Largest alignment, as a power of two */
+#define ALIGN_SHIFT_MAX 20
+
+/* Bytes of a data directive scanned into one AST_DATA node */
+#define DATA_RUN_SIZE 4096
 
 /* Convert token type to string */
 #define tokstr1(tt) \
@@ -63,6 +70,7 @@ static const char *toktab[] = {
     [TT_NUMBER]     = symtok("number"),
     [TT_COMMENT]    = symtok("comment"),
     [TT_LABEL]      = symtok("label"),
+    [TT_STRING]     = symtok("string"),
     [TT_COMMA]      = qtok(","),
     [TT_AT]         = qtok("@"),
     [TT_NEWLINE]    = symtok("newline"),
@@ -88,6 +96,10 @@ static const char *toktab[] = {
     [TT_SRR]        = qtok("srr"),
     [TT_SRW]        = qtok("srw"),
     [TT_OR]         = qtok("or"),
+    [TT_ADD]        = qtok("add"),
+    [TT_SUB]        = qtok("sub"),
+    [TT_AND]        = qtok("and"),
+    [TT_XOR]        = qtok("xor"),
     [TT_LITR]       = qtok("litr"),
     [TT_STB]        = qtok("stb"),
     [TT_STW]        = qtok("stw"),
@@ -98,9 +110,20 @@ static const char *toktab[] = {
     [TT_LDL]        = qtok("ldl"),
     [TT_LDQ]        = qtok("ldq"),
     [TT_B]          = qtok("b"),
+    [TT_BEQ]        = qtok("beq"),
+    [TT_BNE]        = qtok("bne"),
+    [TT_BLT]        = qtok("blt"),
+    [TT_BGE]        = qtok("bge"),
+    [TT_BLTU]       = qtok("bltu"),
+    [TT_BGEU]       = qtok("bgeu"),
     [TT_BYTE]       = qtok(".byte"),
+    [TT_WORD]       = qtok(".word"),
+    [TT_QUAD]       = qtok(".quad"),
     [TT_SKIP]       = qtok(".skip"),
-    [TT_ORIGIN]     = qtok(".origin")
+    [TT_ORIGIN]     = qtok(".origin"),
+    [TT_INCBIN]     = qtok(".incbin"),
+    [TT_ALIGN]      = qtok(".align"),
+    [TT_BALIGN]     = qtok(".balign")
 };
 
 /*
@@ -114,14 +137,21 @@ static const char *toktab[] = {
 static int
 parse_scan(struct arki_state *state, struct token *tok)
 {
+    uint64_t start;
+    int error;
+
     if (state == NULL || tok == NULL) {
         return -1;
     }
 
-    if (lexer_scan(state, tok) < 0) {
+    start = arki_prof_begin(&state->prof);
+    error = lexer_scan(state, tok);
+    arki_prof_end(&state->prof, ARKI_PROF_LEX, start);
+    if (error < 0) {
         return -1;
     }
 
+    ++arki_prof_cur(&state->prof)->tokens;
     return 0;
 }
 
@@ -159,7 +189,8 @@ parse_expect(struct arki_state *state, struct token *tok, tt_t what)
  * @tok:    Last token
  * @res:    Symbol result
  *
- * XXX: Symbol might be NULL on first pass!
+ * XXX: Symbol might be NULL on first pass, in single-pass mode
+ *      or if it is external to an object!
  *
  * Returns zero on success
  */
@@ -167,6 +198,7 @@ static int
 parse_get_sym(struct arki_state *state, const char *name, struct symbol **res)
 {
     struct symbol *sym;
+    uint64_t start;
 
     if (state == NULL || name == NULL) {
         return -1;
@@ -176,8 +208,10 @@ parse_get_sym(struct arki_state *state, const char *name, struct symbol **res)
         return -1;
     }
 
+    start = arki_prof_begin(&state->prof);
     sym = symbol_by_name(&state->symtab, name);
-    if (sym == NULL && state->pass_count > 0) {
+    arki_prof_end(&state->prof, ARKI_PROF_SYMBOL, start);
+    if (sym == NULL && state->pass_count > 0 && !state->one_pass && !state->obj) {
         trace_error(state, "undefined reference to '%s'\n", name);
         return -1;
     }
@@ -238,6 +272,7 @@ parse_source(struct arki_state *state, struct token *tok, struct ast_node **res)
         }
 
         rhs->symbol = sym;
+        rhs->name = tok->s;
         break;
     default:
         /* EXPECT <register> */
@@ -436,7 +471,8 @@ parse_srw(struct arki_state *state, struct token *tok, struct ast_node **res)
 }
 
 /*
- * Parse the 'or' instruction
+ * Parse an ALU instruction ('or', 'add', 'sub', 'and' or
+ * 'xor'), the source may be a register or an immediate
  *
  * @state:  Assembler state
  * @tok:    Last token
@@ -445,9 +481,10 @@ parse_srw(struct arki_state *state, struct token *tok, struct ast_node **res)
  * Returns zero on success
  */
 static int
-parse_or(struct arki_state *state, struct token *tok, struct ast_node **res)
+parse_alu(struct arki_state *state, struct token *tok, struct ast_node **res)
 {
     struct ast_node *left, *root, *right;
+    ast_type_t type;
     reg_t rd;
 
     if (state == NULL || tok == NULL) {
@@ -458,12 +495,28 @@ parse_or(struct arki_state *state, struct token *tok, struct ast_node **res)
         return -1;
     }
 
-    if (tok->type != TT_OR) {
+    switch (tok->type) {
+    case TT_OR:
+        type = AST_OR;
+        break;
+    case TT_ADD:
+        type = AST_ADD;
+        break;
+    case TT_SUB:
+        type = AST_SUB;
+        break;
+    case TT_AND:
+        type = AST_AND;
+        break;
+    case TT_XOR:
+        type = AST_XOR;
+        break;
+    default:
         return -1;
     }
 
-    if (ast_alloc_node(state, AST_OR, &root) < 0) {
-        trace_error(state, "failed to allocate AST_OR\n");
+    if (ast_alloc_node(state, type, &root) < 0) {
+        trace_error(state, "failed to allocate %s node\n", tokstr(tok));
         return -1;
     }
 
@@ -561,6 +614,7 @@ static int
 parse_label(struct arki_state *state, struct token *tok)
 {
     struct symbol *sym;
+    uint64_t start;
     int error;
 
     if (state == NULL || tok == NULL) {
@@ -571,7 +625,16 @@ parse_label(struct arki_state *state, struct token *tok)
         return -1;
     }
 
-    if (state->pass_count == 0) {
+    if (state->pass_count != 0) {
+        return 0;
+    }
+
+    /*
+     * Labels are created on the first sizing pass and only
+     * moved by the ones after it, in the same order.
+     */
+    if (state->relax_pass == 0) {
+        start = arki_prof_begin(&state->prof);
         error = symbol_table_new(
             &state->symtab,
             tok->s,
@@ -579,14 +642,18 @@ parse_label(struct arki_state *state, struct token *tok)
             &sym
         );
 
+        arki_prof_end(&state->prof, ARKI_PROF_SYMBOL, start);
         if (error < 0) {
             trace_error(state, "failed to allocate symbol\n");
             return -1;
         }
-
-        sym->vpc = arki_get_vpc(state);
+    } else if ((sym = symbol_by_id(&state->symtab, state->label_idx)) == NULL) {
+        trace_error(state, "label '%s' lost between passes\n", tok->s);
+        return -1;
     }
 
+    ++state->label_idx;
+    sym->vpc = arki_get_vpc(state);
     return 0;
 }
 
@@ -791,7 +858,62 @@ parse_load(struct arki_state *state, struct token *tok, struct ast_node **res)
 }
 
 /*
- * Parse a '.byte' directive
+ * Scan a run of plain numbers of a data directive in bulk
+ * and hang them off the list as a single AST_DATA node
+ *
+ * @state:  Assembler state
+ * @width:  Bytes per number
+ * @cur:    Last node of the list, advanced past the run
+ * @off:    Image offset of the run, advanced past it
+ * @more:   Set if an element is next rather than the end
+ *
+ * Returns the number of numbers scanned, or less than
+ * zero on failure
+ */
+static ssize_t
+parse_data_run(struct arki_state *state, size_t width, struct ast_node **cur,
+    size_t *off, bool *more)
+{
+    uint8_t buf[DATA_RUN_SIZE];
+    struct ast_node *node;
+    uint8_t *data;
+    size_t count, len;
+    uint64_t start;
+
+    start = arki_prof_begin(&state->prof);
+    count = lexer_scan_data(state, width, buf, sizeof(buf) / width, more);
+    arki_prof_end(&state->prof, ARKI_PROF_LEX, start);
+    arki_prof_cur(&state->prof)->tokens += count;
+    if (count == 0) {
+        return 0;
+    }
+
+    len = count * width;
+    if ((data = ptrbox_alloc(&state->ptrbox, len)) == NULL) {
+        trace_error(state, "failed to allocate data run\n");
+        return -1;
+    }
+
+    if (ast_alloc_node(state, AST_DATA, &node) < 0) {
+        trace_error(state, "failed to allocate AST_DATA\n");
+        return -1;
+    }
+
+    memcpy(data, buf, len);
+    node->data = data;
+    node->v = len;
+    (*cur)->right = node;
+    *cur = node;
+    *off += len;
+    return count;
+}
+
+/*
+ * Parse a '.byte', '.word' or '.quad' directive
+ *
+ * Plain numbers are scanned straight out of the input in
+ * runs, only the odd element (e.g., '@') gets a node and
+ * goes through the lexer.
  *
  * @state:  Assembler state
  * @tok:    Last token
@@ -800,9 +922,14 @@ parse_load(struct arki_state *state, struct token *tok, struct ast_node **res)
  * Returns zero on success
  */
 static int
-parse_byte(struct arki_state *state, struct token *tok, struct ast_node **res)
+parse_data(struct arki_state *state, struct token *tok, struct ast_node **res)
 {
     struct ast_node *root, *cur;
+    size_t off, width;
+    ssize_t count;
+    ast_type_t type;
+    bool more;
+    int error;
 
     if (state == NULL || tok == NULL) {
         return -1;
@@ -812,37 +939,82 @@ parse_byte(struct arki_state *state, struct token *tok, struct ast_node **res)
         return -1;
     }
 
-    if (tok->type != TT_BYTE) {
-        return -1;
-    }
-
-    if (ast_alloc_node(state, AST_BYTE, &root) < 0) {
-        trace_error(state, "failed to allocate AST_BYTE\n");
-        return -1;
-    }
-
-    if (parse_scan(state, tok) < 0) {
-        ueof(state);
+    switch (tok->type) {
+    case TT_BYTE:
+        type = AST_BYTE;
+        width = 1;
+        break;
+    case TT_WORD:
+        type = AST_WORD;
+        width = 2;
+        break;
+    case TT_QUAD:
+        type = AST_QUAD;
+        width = 8;
+        break;
+    default:
         return -1;
     }
 
-    if (tok->type != TT_NUMBER && tok->type != TT_AT) {
-        utok1(state, "numbers or '@'", tokstr(tok));
+    off = state->vpc;
+    if (ast_alloc_node(state, type, &root) < 0) {
+        trace_error(state, "failed to allocate data directive\n");
         return -1;
     }
 
     cur = root;
     for (;;) {
-        if (ast_alloc_node(state, AST_NUMBER, &cur->right) < 0) {
-            trace_error(state, "failed to allocate AST_NUMBER\n");
-            return -1;
-        }
+        do {
+            count = parse_data_run(state, width, &cur, &off, &more);
+            if (count < 0) {
+                return -1;
+            }
+        } while (more && (size_t)count == DATA_RUN_SIZE / width);
 
-        cur = cur->right;
-        if (tok->type == TT_AT) {
-            cur->v = state->out_size;
-        } else {
-            cur->v = tok->v;
+        if (more) {
+            if (parse_scan(state, tok) < 0) {
+                ueof(state);
+                return -1;
+            }
+
+            if (tok->type != TT_NUMBER && tok->type != TT_AT) {
+                utok1(state, "numbers or '@'", tokstr(tok));
+                return -1;
+            }
+
+            if (tok->type == TT_AT && width != 1) {
+                trace_error(state, "'@' only fits in a '.byte'\n");
+                return -1;
+            }
+
+            if (ast_alloc_node(state, AST_NUMBER, &cur->right) < 0) {
+                trace_error(state, "failed to allocate AST_NUMBER\n");
+                return -1;
+            }
+
+            cur = cur->right;
+            if (tok->type != TT_AT) {
+                cur->v = tok->v;
+            } else if (!state->one_pass && !state->obj) {
+                cur->v = state->out_size;
+            } else if (arki_emitting(state)) {
+                /* Output size is not known until the end (or link) */
+                error = fixup_table_add(
+                    &state->fixups,
+                    FIXUP_SIZE8,
+                    NULL,
+                    off,
+                    0,
+                    state->line_num
+                );
+
+                if (error < 0) {
+                    trace_error(state, "failed to allocate fixup\n");
+                    return -1;
+                }
+            }
+
+            off += width;
         }
 
         if (parse_scan(state, tok) < 0) {
@@ -850,7 +1022,7 @@ parse_byte(struct arki_state *state, struct token *tok, struct ast_node **res)
             return -1;
         }
 
-        if (tok->type == TT_NEWLINE) {
+        if (tok->type == TT_NEWLINE || tok->type == TT_COMMENT) {
             break;
         }
 
@@ -858,16 +1030,6 @@ parse_byte(struct arki_state *state, struct token *tok, struct ast_node **res)
             utok1(state, tokstr1(TT_COMMA), tokstr(tok));
             return -1;
         }
-
-        if (parse_scan(state, tok) < 0) {
-            ueof(state);
-            return -1;
-        }
-
-        if (tok->type != TT_NUMBER && tok->type != TT_AT) {
-            utok1(state, "numbers or '@'", tokstr(tok));
-            return -1;
-        }
     }
 
     *res = root;
@@ -929,6 +1091,133 @@ parse_branch(struct arki_state *state, struct token *tok, struct ast_node **res)
     return 0;
 }
 
+/*
+ * Parse a register operand into a new AST_REG node
+ *
+ * @state:  Assembler state
+ * @tok:    Last token
+ * @res:    AST node result
+ *
+ * Returns zero on success
+ */
+static int
+parse_reg(struct arki_state *state, struct token *tok, struct ast_node **res)
+{
+    struct ast_node *node;
+    reg_t reg;
+
+    if (parse_scan(state, tok) < 0) {
+        ueof(state);
+        return -1;
+    }
+
+    /* EXPECT <register> */
+    if ((reg = token_to_reg(tok->type)) == REG_BAD) {
+        utok1(state, symtok("register"), tokstr(tok));
+        return -1;
+    }
+
+    if (ast_alloc_node(state, AST_REG, &node) < 0) {
+        trace_error(state, "failed to allocate AST_REG\n");
+        return -1;
+    }
+
+    node->reg = reg;
+    *res = node;
+    return 0;
+}
+
+/*
+ * Parse a compare-and-branch instruction, which has the
+ * form '<bcc> <register>, <register>, <label>'
+ *
+ * @state:  Assembler state
+ * @tok:    Last token
+ * @res:    AST node result
+ *
+ * Returns zero on success
+ */
+static int
+parse_bcond(struct arki_state *state, struct token *tok, struct ast_node **res)
+{
+    struct ast_node *root;
+    struct symbol *sym;
+    ast_type_t type;
+
+    if (state == NULL || tok == NULL) {
+        return -1;
+    }
+
+    if (res == NULL) {
+        return -1;
+    }
+
+    switch (tok->type) {
+    case TT_BEQ:
+        type = AST_BEQ;
+        break;
+    case TT_BNE:
+        type = AST_BNE;
+        break;
+    case TT_BLT:
+        type = AST_BLT;
+        break;
+    case TT_BGE:
+        type = AST_BGE;
+        break;
+    case TT_BLTU:
+        type = AST_BLTU;
+        break;
+    case TT_BGEU:
+        type = AST_BGEU;
+        break;
+    default:
+        return -1;
+    }
+
+    if (ast_alloc_node(state, type, &root) < 0) {
+        trace_error(state, "failed to allocate %s node\n", tokstr(tok));
+        return -1;
+    }
+
+    if (parse_reg(state, tok, &root->left) < 0) {
+        return -1;
+    }
+
+    /* EXPECT ',' */
+    if (parse_expect(state, tok, TT_COMMA) < 0) {
+        return -1;
+    }
+
+    if (parse_reg(state, tok, &root->right) < 0) {
+        return -1;
+    }
+
+    /* EXPECT ',' */
+    if (parse_expect(state, tok, TT_COMMA) < 0) {
+        return -1;
+    }
+
+    /* EXPECT <label> */
+    if (parse_expect(state, tok, TT_IDENT) < 0) {
+        return -1;
+    }
+
+    if (parse_get_sym(state, tok->s, &sym) < 0) {
+        return -1;
+    }
+
+    if (sym != NULL && sym->type != SYMBOL_LABEL) {
+        trace_error(state, "'%s' is not a label\n", tok->s);
+        return -1;
+    }
+
+    root->symbol = sym;
+    root->name = tok->s;
+    *res = root;
+    return 0;
+}
+
 /*
  * Parse a '.skip' directive
  *
@@ -971,6 +1260,179 @@ parse_skip(struct arki_state *state, struct token *tok, struct ast_node **res)
     return 0;
 }
 
+/*
+ * Parse an '.incbin' directive, an offset and length into
+ * the file may follow its path
+ *
+ * @state:  Assembler state
+ * @tok:    Last token
+ * @res:    Result AST node is written here
+ *
+ * Returns zero on success
+ */
+static int
+parse_incbin(struct arki_state *state, struct token *tok, struct ast_node **res)
+{
+    struct ast_node *root, *args[2];
+
+    if (state == NULL || tok == NULL) {
+        return -1;
+    }
+
+    if (tok->type != TT_INCBIN) {
+        return -1;
+    }
+
+    if (parse_expect(state, tok, TT_STRING) < 0) {
+        return -1;
+    }
+
+    if (ast_alloc_node(state, AST_INCBIN, &root) < 0) {
+        trace_error(state, "failed to allocate AST_INCBIN\n");
+        return -1;
+    }
+
+    if (ast_alloc_node(state, AST_NUMBER, &root->left) < 0) {
+        trace_error(state, "failed to allocate AST_NUMBER\n");
+        return -1;
+    }
+
+    if (ast_alloc_node(state, AST_NUMBER, &root->right) < 0) {
+        trace_error(state, "failed to allocate AST_NUMBER\n");
+        return -1;
+    }
+
+    /* Whole file unless told otherwise */
+    root->name = tok->s;
+    root->left->v = 0;
+    root->right->v = -1;
+    args[0] = root->left;
+    args[1] = root->right;
+
+    for (int i = 0; i < 2; ++i) {
+        if (parse_scan(state, tok) < 0) {
+            ueof(state);
+            return -1;
+        }
+
+        if (tok->type == TT_NEWLINE || tok->type == TT_COMMENT) {
+            break;
+        }
+
+        if (tok->type != TT_COMMA) {
+            utok1(state, tokstr1(TT_COMMA), tokstr(tok));
+            return -1;
+        }
+
+        if (parse_expect(state, tok, TT_NUMBER) < 0) {
+            return -1;
+        }
+
+        if (tok->v < 0) {
+            trace_error(state, "negative .incbin argument\n");
+            return -1;
+        }
+
+        args[i]->v = tok->v;
+    }
+
+    *res = root;
+    return 0;
+}
+
+/*
+ * Parse an '.align' or '.balign' directive, '.align N' pads
+ * to a 2^N byte boundary and '.balign N' to an N byte one.
+ * Either may be followed by a fill byte.
+ *
+ * @state:  Assembler state
+ * @tok:    Last token
+ * @res:    Result AST node is written here
+ *
+ * Returns zero on success
+ */
+static int
+parse_align(struct arki_state *state, struct token *tok, struct ast_node **res)
+{
+    struct ast_node *root;
+    tt_t type;
+
+    if (state == NULL || tok == NULL) {
+        return -1;
+    }
+
+    type = tok->type;
+    if (type != TT_ALIGN && type != TT_BALIGN) {
+        return -1;
+    }
+
+    if (parse_expect(state, tok, TT_NUMBER) < 0) {
+        return -1;
+    }
+
+    if (ast_alloc_node(state, AST_ALIGN, &root) < 0) {
+        trace_error(state, "failed to allocate AST_ALIGN\n");
+        return -1;
+    }
+
+    if (ast_alloc_node(state, AST_NUMBER, &root->right) < 0) {
+        trace_error(state, "failed to allocate AST_NUMBER\n");
+        return -1;
+    }
+
+    if (ast_alloc_node(state, AST_NUMBER, &root->left) < 0) {
+        trace_error(state, "failed to allocate AST_NUMBER\n");
+        return -1;
+    }
+
+    if (type == TT_ALIGN) {
+        if (tok->v < 0 || tok->v > ALIGN_SHIFT_MAX) {
+            trace_error(state, "bad alignment 2^%zd\n", tok->v);
+            return -1;
+        }
+
+        root->right->v = (ssize_t)1 << tok->v;
+    } else {
+        if (tok->v <= 0 || (tok->v & (tok->v - 1)) != 0) {
+            trace_error(state, "alignment %zd is not a power of two\n", tok->v);
+            return -1;
+        }
+
+        if (tok->v > ((ssize_t)1 << ALIGN_SHIFT_MAX)) {
+            trace_error(state, "bad alignment %zd\n", tok->v);
+            return -1;
+        }
+
+        root->right->v = tok->v;
+    }
+
+    /* Pad with NOPs unless told otherwise */
+    root->left->v = 0x00;
+    if (parse_scan(state, tok) < 0) {
+        ueof(state);
+        return -1;
+    }
+
+    if (tok->type == TT_COMMA) {
+        if (parse_expect(state, tok, TT_NUMBER) < 0) {
+            return -1;
+        }
+
+        if (tok->v < 0 || tok->v > 0xFF) {
+            trace_error(state, "fill %zd does not fit in a byte\n", tok->v);
+            return -1;
+        }
+
+        root->left->v = tok->v;
+    } else if (tok->type != TT_NEWLINE && tok->type != TT_COMMENT) {
+        utok1(state, tokstr1(TT_COMMA), tokstr(tok));
+        return -1;
+    }
+
+    *res = root;
+    return 0;
+}
+
 /*
  * Parse an '.origin' directive
  *
@@ -994,6 +1456,13 @@ parse_origin(struct arki_state *state, struct token *tok)
         return -1;
     }
 
+    /* Objects are linked to their load address */
+    if (state->obj) {
+        state->obj_origin = tok->v;
+        state->obj_origin_set = true;
+        return 0;
+    }
+
     state->origin = tok->v;
     return 0;
 }
@@ -1010,6 +1479,8 @@ static int
 parse_begin(struct arki_state *state, struct token *tok)
 {
     struct ast_node *root = NULL;
+    uint64_t start;
+    int error;
 
     if (state == NULL || tok == NULL) {
         return -1;
@@ -1041,7 +1512,11 @@ parse_begin(struct arki_state *state, struct token *tok)
 
         break;
     case TT_OR:
-        if (parse_or(state, tok, &root) < 0) {
+    case TT_ADD:
+    case TT_SUB:
+    case TT_AND:
+    case TT_XOR:
+        if (parse_alu(state, tok, &root) < 0) {
             return -1;
         }
 
@@ -1071,7 +1546,9 @@ parse_begin(struct arki_state *state, struct token *tok)
 
         break;
     case TT_BYTE:
-        if (parse_byte(state, tok, &root) < 0) {
+    case TT_WORD:
+    case TT_QUAD:
+        if (parse_data(state, tok, &root) < 0) {
             return -1;
         }
 
@@ -1081,12 +1558,36 @@ parse_begin(struct arki_state *state, struct token *tok)
             return -1;
         }
 
+        break;
+    case TT_INCBIN:
+        if (parse_incbin(state, tok, &root) < 0) {
+            return -1;
+        }
+
+        break;
+    case TT_ALIGN:
+    case TT_BALIGN:
+        if (parse_align(state, tok, &root) < 0) {
+            return -1;
+        }
+
         break;
     case TT_B:
         if (parse_branch(state, tok, &root) < 0) {
             return -1;
         }
 
+        break;
+    case TT_BEQ:
+    case TT_BNE:
+    case TT_BLT:
+    case TT_BGE:
+    case TT_BLTU:
+    case TT_BGEU:
+        if (parse_bcond(state, tok, &root) < 0) {
+            return -1;
+        }
+
         break;
     case TT_NEWLINE:
         /* Ignored */
@@ -1112,33 +1613,105 @@ parse_begin(struct arki_state *state, struct token *tok)
     }
 
     if (root != NULL) {
-        if (cg_resolve_node(state, root) < 0)
+        start = arki_prof_begin(&state->prof);
+        error = cg_resolve_node(state, root);
+        arki_prof_end(&state->prof, ARKI_PROF_CODEGEN, start);
+        if (error < 0)
             return -1;
     }
 
     return 0;
 }
 
+/*
+ * Returns the kind of pass about to be made, for the
+ * timing report
+ *
+ * @state: Assembler state
+ */
+static const char *
+parse_pass_kind(struct arki_state *state)
+{
+    if (state->one_pass) {
+        return "single";
+    }
+
+    return (state->pass_count == 0) ? "size" : "emit";
+}
+
 int
 arki_parse(struct arki_state *state)
 {
+    struct ptrbox_mark mark;
+    uint64_t pass_start, start;
+    int error;
+
     if (state == NULL) {
         return -1;
     }
 
-    while (lexer_scan(state, &state->last_tok) == 0) {
-        if (parse_begin(state, &state->last_tok) < 0) {
+    pass_start = arki_prof_pass_begin(&state->prof, parse_pass_kind(state));
+
+    /*
+     * Tokens and AST nodes only live as long as the statement
+     * they belong to, so roll the pointer box back after each
+     * one to keep memory use flat no matter the input size.
+     */
+    ptrbox_mark(&state->ptrbox, &mark);
+    while (parse_scan(state, &state->last_tok) == 0) {
+        if (list_stmt(state, state->last_tok.type) < 0) {
+            return -1;
+        }
+
+        start = arki_prof_begin(&state->prof);
+        error = parse_begin(state, &state->last_tok);
+        arki_prof_end(&state->prof, ARKI_PROF_PARSE, start);
+        if (error < 0) {
             return -1;
         }
+
+        ptrbox_reset(&state->ptrbox, &mark);
+        arki_input_release(state);
     }
 
     if (state->pass_count == 0) {
         state->out_size = state->vpc;
     }
 
-    ++state->pass_count;
+    state->end_addr = arki_get_vpc(state);
+    list_end(state);
+
+    /*
+     * Size the output image now that we know how big it is,
+     * in single-pass mode it has been filled in as we went.
+     * If a mov was widened the labels after it may have moved,
+     * so size everything again.
+     */
+    if (state->pass_count == 0 && !state->one_pass) {
+        if (state->relax_pass == 0 && cg_settle_movs(state) < 0) {
+            return -1;
+        }
+
+        if (state->unsettled) {
+            ++state->relax_pass;
+        } else if (arki_image_size(state, state->out_size) < 0) {
+            return -1;
+        } else {
+            ++state->pass_count;
+        }
+    } else {
+        ++state->pass_count;
+    }
+
+    state->unsettled = false;
+    state->mov_idx = 0;
+    state->label_idx = 0;
+    state->origin = 0;
     state->line_num = 1;
     state->vpc = 0;
-    lseek(state->in_fd, 0, SEEK_SET);
+    state->in_pos = 0;
+    state->in_dropped = 0;
+    state->putback = '\0';
+    arki_prof_pass_end(&state->prof, pass_start);
     return 0;
 }
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+#include "arki/prof.h"
+#include "arki/libarki.h"
+
+/* Names of phases as they appear in reports */
+static const char *phase_names[ARKI_PROF_PHASES] = {
+    [ARKI_PROF_LEX]     = "lex",
+    [ARKI_PROF_PARSE]   = "parse",
+    [ARKI_PROF_SYMBOL]  = "symbol",
+    [ARKI_PROF_CODEGEN] = "codegen",
+    [ARKI_PROF_IO]      = "io"
+};
+
+/* Nanoseconds to milliseconds, for text reports */
+#define NS_TO_MS(ns) ((double)(ns) / 1000000.0)
+
+uint64_t
+arki_prof_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+uint64_t
+arki_prof_begin(struct arki_prof *prof)
+{
+    if (!prof->enabled) {
+        return 0;
+    }
+
+    if (++prof->depth < ARKI_PROF_DEPTH) {
+        prof->child_ns[prof->depth] = 0;
+    }
+
+    return arki_prof_now();
+}
+
+void
+arki_prof_end(struct arki_prof *prof, arki_prof_phase_t phase, uint64_t start)
+{
+    struct arki_prof_stat *stat;
+    uint64_t ns, child = 0;
+
+    if (!prof->enabled) {
+        return;
+    }
+
+    ns = arki_prof_now() - start;
+    if (prof->depth < ARKI_PROF_DEPTH) {
+        child = prof->child_ns[prof->depth];
+    }
+
+    /* Charge the caller for all of it, this phase for its own */
+    if (--prof->depth < ARKI_PROF_DEPTH) {
+        prof->child_ns[prof->depth] += ns;
+    }
+
+    if (prof->in_pass) {
+        stat = &arki_prof_cur(prof)->phases[phase];
+    } else if (phase == ARKI_PROF_IO) {
+        stat = &prof->io;
+    } else {
+        return;
+    }
+
+    stat->ns += (ns > child) ? ns - child : 0;
+    ++stat->calls;
+}
+
+uint64_t
+arki_prof_pass_begin(struct arki_prof *prof, const char *kind)
+{
+    if (!prof->enabled) {
+        return 0;
+    }
+
+    arki_prof_cur(prof)->kind = kind;
+    prof->in_pass = true;
+    prof->depth = 0;
+    prof->child_ns[0] = 0;
+    return arki_prof_now();
+}
+
+void
+arki_prof_pass_end(struct arki_prof *prof, uint64_t start)
+{
+    if (!prof->enabled) {
+        return;
+    }
+
+    arki_prof_cur(prof)->ns += arki_prof_now() - start;
+    prof->in_pass = false;
+    ++prof->pass_count;
+}
+
+/*
+ * Write a string as a JSON string
+ *
+ * @s:  String to write
+ * @fp: File to write to
+ */
+static void
+prof_json_str(const char *s, FILE *fp)
+{
+    fputc('"', fp);
+    for (; *s != '\0'; ++s) {
+        if (*s == '"' || *s == '\\') {
+            fprintf(fp, "\\%c", *s);
+        } else if ((uint8_t)*s < 0x20) {
+            fprintf(fp, "\\u%04x", (uint8_t)*s);
+        } else {
+            fputc(*s, fp);
+        }
+    }
+
+    fputc('"', fp);
+}
+
+/*
+ * Write a report as a single line of JSON
+ *
+ * @prof: Report
+ * @path: Path of the assembled source
+ * @fp:   File to write to
+ */
+static void
+prof_write_json(const struct arki_prof *prof, const char *path, FILE *fp)
+{
+    const struct arki_prof_pass *pass;
+    const struct arki_prof_stat *stat;
+    size_t count;
+
+    fprintf(fp, "{\"version\":\"%s\",\"file\":", ARKI_VERSION);
+    prof_json_str(path, fp);
+    fprintf(
+        fp,
+        ",\"total_ns\":%" PRIu64 ",\"symbols\":%zu,\"ptrbox_peak\":%zu"
+        ",\"io\":{\"calls\":%" PRIu64 ",\"ns\":%" PRIu64 "},\"passes\":[",
+        prof->total_ns,
+        prof->symbols,
+        prof->ptrbox_peak,
+        prof->io.calls,
+        prof->io.ns
+    );
+
+    count = (prof->pass_count < ARKI_PROF_PASS_MAX) ? prof->pass_count : ARKI_PROF_PASS_MAX;
+    for (size_t i = 0; i < count; ++i) {
+        pass = &prof->passes[i];
+        fprintf(
+            fp,
+            "%s{\"kind\":\"%s\",\"ns\":%" PRIu64 ",\"tokens\":%zu",
+            (i > 0) ? "," : "",
+            pass->kind,
+            pass->ns,
+            pass->tokens
+        );
+
+        for (size_t j = 0; j < ARKI_PROF_PHASES; ++j) {
+            stat = &pass->phases[j];
+            fprintf(
+                fp,
+                ",\"%s\":{\"calls\":%" PRIu64 ",\"ns\":%" PRIu64 "}",
+                phase_names[j],
+                stat->calls,
+                stat->ns
+            );
+        }
+
+        fputc('}', fp);
+    }
+
+    fputs("]}\n", fp);
+}
+
+/*
+ * Write a report as text
+ *
+ * @prof: Report
+ * @path: Path of the assembled source
+ * @fp:   File to write to
+ */
+static void
+prof_write_text(const struct arki_prof *prof, const char *path, FILE *fp)
+{
+    const struct arki_prof_pass *pass;
+    const struct arki_prof_stat *stat;
+    size_t count;
+
+    fprintf(fp, "[*] time report for %s (arki v%s)\n", path, ARKI_VERSION);
+    count = (prof->pass_count < ARKI_PROF_PASS_MAX) ? prof->pass_count : ARKI_PROF_PASS_MAX;
+    for (size_t i = 0; i < count; ++i) {
+        pass = &prof->passes[i];
+        fprintf(
+            fp,
+            "    pass %zu (%s)%s: %.3f ms, %zu tokens\n",
+            i + 1,
+            pass->kind,
+            (i + 1 == ARKI_PROF_PASS_MAX && prof->pass_count > count) ? " and later" : "",
+            NS_TO_MS(pass->ns),
+            pass->tokens
+        );
+
+        for (size_t j = 0; j < ARKI_PROF_PHASES; ++j) {
+            stat = &pass->phases[j];
+            if (stat->calls == 0) {
+                continue;
+            }
+
+            fprintf(
+                fp,
+                "        %-8s %10" PRIu64 " calls %10.3f ms\n",
+                phase_names[j],
+                stat->calls,
+                NS_TO_MS(stat->ns)
+            );
+        }
+    }
+
+    fprintf(
+        fp,
+        "    file io  %10" PRIu64 " calls %10.3f ms\n",
+        prof->io.calls,
+        NS_TO_MS(prof->io.ns)
+    );
+
+    fprintf(fp, "    total: %.3f ms\n", NS_TO_MS(prof->total_ns));
+    fprintf(fp, "    symbols: %zu\n", prof->symbols);
+    fprintf(fp, "    ptrbox peak: %zu bytes\n", prof->ptrbox_peak);
+}
+
+int
+arki_prof_write(const struct arki_prof *prof, const char *path, FILE *fp, bool json)
+{
+    if (prof == NULL || path == NULL || fp == NULL) {
+        return -1;
+    }
+
+    if (json) {
+        prof_write_json(prof, path, fp);
+    } else {
+        prof_write_text(prof, path, fp);
+    }
+
+    return ferror(fp) ? -1 : 0;
+}
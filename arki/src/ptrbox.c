@@ -5,6 +5,38 @@
 #include <string.h>
 #include "arki/ptrbox.h"
 
+/* Allocation alignment (must be power-of-two) */
+#define PTRBOX_ALIGN 16
+#define PTRBOX_ALIGN_UP(n) (((n) + PTRBOX_ALIGN - 1) & ~(size_t)(PTRBOX_ALIGN - 1))
+
+/*
+ * Allocate a new chunk
+ *
+ * @size: Minimum usable size of chunk
+ *
+ * Returns the new chunk on success
+ */
+static struct ptrbox_chunk *
+ptrbox_chunk_new(size_t size)
+{
+    struct ptrbox_chunk *chunk;
+    size_t hdr_size;
+
+    if (size < PTRBOX_CHUNK_SIZE) {
+        size = PTRBOX_CHUNK_SIZE;
+    }
+
+    hdr_size = PTRBOX_ALIGN_UP(sizeof(*chunk));
+    if ((chunk = malloc(hdr_size + size)) == NULL) {
+        return NULL;
+    }
+
+    chunk->data = (uint8_t *)chunk + hdr_size;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
 int
 ptrbox_init(struct ptrbox *res)
 {
@@ -13,74 +45,124 @@ ptrbox_init(struct ptrbox *res)
         return -1;
     }
 
-    TAILQ_INIT(&res->entries);
+    TAILQ_INIT(&res->chunks);
+    if ((res->cur = ptrbox_chunk_new(PTRBOX_CHUNK_SIZE)) == NULL) {
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    TAILQ_INSERT_TAIL(&res->chunks, res->cur, link);
     res->entry_count = 0;
+    res->bytes_used = 0;
+    res->bytes_peak = 0;
     return 0;
 }
 
 void *
 ptrbox_alloc(struct ptrbox *ptrbox, size_t sz)
 {
-    struct ptrbox_entry *entry;
+    struct ptrbox_chunk *chunk, *next;
+    void *p;
 
     if (ptrbox == NULL || sz == 0) {
         return NULL;
     }
 
-    if ((entry = malloc(sizeof(*entry))) == NULL) {
-        return NULL;
+    sz = PTRBOX_ALIGN_UP(sz);
+    chunk = ptrbox->cur;
+
+    /*
+     * If the current chunk is full, move on to the next chunk
+     * if it was kept around from before a reset and is big
+     * enough, otherwise put a new one after the current one.
+     */
+    if ((chunk->size - chunk->used) < sz) {
+        next = TAILQ_NEXT(chunk, link);
+        if (next != NULL && next->size >= sz) {
+            next->used = 0;
+            chunk = next;
+        } else {
+            if ((next = ptrbox_chunk_new(sz)) == NULL) {
+                return NULL;
+            }
+
+            TAILQ_INSERT_AFTER(&ptrbox->chunks, chunk, next, link);
+            chunk = next;
+        }
+
+        ptrbox->cur = chunk;
     }
 
-    if ((entry->data = malloc(sz)) == NULL) {
-        free(entry);
-        return NULL;
-    }
+    p = &chunk->data[chunk->used];
+    chunk->used += sz;
 
-    TAILQ_INSERT_TAIL(&ptrbox->entries, entry, link);
     ++ptrbox->entry_count;
-    return entry->data;
+    ptrbox->bytes_used += sz;
+    if (ptrbox->bytes_used > ptrbox->bytes_peak) {
+        ptrbox->bytes_peak = ptrbox->bytes_used;
+    }
+
+    return p;
 }
 
 void *
 ptrbox_strdup(struct ptrbox *ptrbox, const char *s)
 {
-    struct ptrbox_entry *entry;
+    size_t len;
+    char *p;
 
     if (ptrbox == NULL || s == 0) {
         return NULL;
     }
 
-    if ((entry = malloc(sizeof(*entry))) == NULL) {
+    len = strlen(s) + 1;
+    if ((p = ptrbox_alloc(ptrbox, len)) == NULL) {
         return NULL;
     }
 
-    if ((entry->data = strdup(s)) == NULL) {
-        free(entry);
-        return NULL;
+    memcpy(p, s, len);
+    return p;
+}
+
+void
+ptrbox_mark(struct ptrbox *ptrbox, struct ptrbox_mark *res)
+{
+    if (ptrbox == NULL || res == NULL) {
+        return;
     }
 
-    TAILQ_INSERT_TAIL(&ptrbox->entries, entry, link);
-    ++ptrbox->entry_count;
-    return entry->data;
+    res->chunk = ptrbox->cur;
+    res->used = ptrbox->cur->used;
+    res->entry_count = ptrbox->entry_count;
+    res->bytes_used = ptrbox->bytes_used;
+}
+
+void
+ptrbox_reset(struct ptrbox *ptrbox, const struct ptrbox_mark *mark)
+{
+    if (ptrbox == NULL || mark == NULL) {
+        return;
+    }
+
+    ptrbox->cur = mark->chunk;
+    ptrbox->cur->used = mark->used;
+    ptrbox->entry_count = mark->entry_count;
+    ptrbox->bytes_used = mark->bytes_used;
 }
 
 void
 ptrbox_destroy(struct ptrbox *ptrbox)
 {
-    struct ptrbox_entry *entry;
+    struct ptrbox_chunk *chunk;
 
     if (ptrbox == NULL) {
         return;
     }
 
-    if ((entry = TAILQ_FIRST(&ptrbox->entries)) == NULL) {
-        return;
+    while ((chunk = TAILQ_FIRST(&ptrbox->chunks)) != NULL) {
+        TAILQ_REMOVE(&ptrbox->chunks, chunk, link);
+        free(chunk);
     }
 
-    do {
-        TAILQ_REMOVE(&ptrbox->entries, entry, link);
-        free(entry->data);
-        free(entry);
-        entry = TAILQ_FIRST(&ptrbox->entries);
-    } while (entry != NULL);
+    ptrbox->cur = NULL;
 }
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "arki/sha256.h"
+
+#define ROR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/* Round constants (FIPS 180-4, 4.2.2) */
+static const uint32_t k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/*
+ * Hash a single 64 byte block
+ *
+ * @ctx:   Hashing context
+ * @block: Block to hash
+ */
+static void
+sha256_block(struct sha256 *ctx, const uint8_t *block)
+{
+    uint32_t w[64], s[8];
+    uint32_t t1, t2;
+
+    for (int i = 0; i < 16; ++i) {
+        w[i] = (uint32_t)block[i * 4] << 24 |
+               (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 |
+               (uint32_t)block[i * 4 + 3];
+    }
+
+    for (int i = 16; i < 64; ++i) {
+        t1 = ROR(w[i - 2], 17) ^ ROR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        t2 = ROR(w[i - 15], 7) ^ ROR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        w[i] = t1 + w[i - 7] + t2 + w[i - 16];
+    }
+
+    memcpy(s, ctx->state, sizeof(s));
+    for (int i = 0; i < 64; ++i) {
+        t1 = s[7] + (ROR(s[4], 6) ^ ROR(s[4], 11) ^ ROR(s[4], 25)) +
+             ((s[4] & s[5]) ^ (~s[4] & s[6])) + k[i] + w[i];
+        t2 = (ROR(s[0], 2) ^ ROR(s[0], 13) ^ ROR(s[0], 22)) +
+             ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+
+        s[7] = s[6];
+        s[6] = s[5];
+        s[5] = s[4];
+        s[4] = s[3] + t1;
+        s[3] = s[2];
+        s[2] = s[1];
+        s[1] = s[0];
+        s[0] = t1 + t2;
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        ctx->state[i] += s[i];
+    }
+}
+
+void
+sha256_init(struct sha256 *ctx)
+{
+    static const uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    memcpy(ctx->state, iv, sizeof(iv));
+    ctx->count = 0;
+}
+
+void
+sha256_update(struct sha256 *ctx, const void *p, size_t n)
+{
+    const uint8_t *in = p;
+    size_t used, take;
+
+    used = ctx->count % 64;
+    ctx->count += n;
+
+    /* Top up a partial block first */
+    if (used > 0) {
+        take = 64 - used;
+        if (take > n) {
+            take = n;
+        }
+
+        memcpy(&ctx->buf[used], in, take);
+        in += take;
+        n -= take;
+
+        if ((used + take) < 64) {
+            return;
+        }
+
+        sha256_block(ctx, ctx->buf);
+    }
+
+    while (n >= 64) {
+        sha256_block(ctx, in);
+        in += 64;
+        n -= 64;
+    }
+
+    memcpy(ctx->buf, in, n);
+}
+
+void
+sha256_final(struct sha256 *ctx, uint8_t res[SHA256_DIGEST_SIZE])
+{
+    uint64_t bits = ctx->count * 8;
+    size_t used = ctx->count % 64;
+
+    ctx->buf[used++] = 0x80;
+    if (used > 56) {
+        memset(&ctx->buf[used], 0, 64 - used);
+        sha256_block(ctx, ctx->buf);
+        used = 0;
+    }
+
+    memset(&ctx->buf[used], 0, 56 - used);
+    for (int i = 0; i < 8; ++i) {
+        ctx->buf[56 + i] = (bits >> (56 - i * 8)) & 0xFF;
+    }
+
+    sha256_block(ctx, ctx->buf);
+    for (int i = 0; i < 8; ++i) {
+        res[i * 4] = (ctx->state[i] >> 24) & 0xFF;
+        res[i * 4 + 1] = (ctx->state[i] >> 16) & 0xFF;
+        res[i * 4 + 2] = (ctx->state[i] >> 8) & 0xFF;
+        res[i * 4 + 3] = ctx->state[i] & 0xFF;
+    }
+}
@@ -3,46 +3,585 @@
  * Provided under the BSD-3 clause.
  */
 
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <fcntl.h>
 #include <errno.h>
 #include "arki/state.h"
 
+/* Block size used when the input cannot be mapped */
+#define INPUT_BLOCK_SIZE 65536
+
+/* Bytes of the image kept in memory when streaming */
+#define STREAM_WINDOW_SIZE (1024 * 1024)
+
+/* Input released at a time when streaming */
+#define STREAM_DROP_SIZE (1024 * 1024)
+
+/*
+ * Load the input source into memory, mapping it if it is a
+ * regular file and reading it in large blocks otherwise.
+ *
+ * @state: Assembler state
+ *
+ * Returns zero on success
+ */
+static int
+arki_state_load(struct arki_state *state, int fd)
+{
+    struct stat st;
+    char *buf = NULL, *tmp;
+    size_t cap = 0, len = 0;
+    ssize_t count;
+    void *mem;
+
+    if (fstat(fd, &st) < 0) {
+        return -1;
+    }
+
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        mem = mmap(
+            NULL,
+            st.st_size,
+            PROT_READ,
+            MAP_PRIVATE,
+            fd,
+            0
+        );
+
+        if (mem != MAP_FAILED) {
+            madvise(mem, st.st_size, MADV_SEQUENTIAL);
+            state->in_buf = mem;
+            state->in_len = st.st_size;
+            state->in_mapped = true;
+            return 0;
+        }
+    }
+
+    for (;;) {
+        if ((cap - len) < INPUT_BLOCK_SIZE) {
+            cap += INPUT_BLOCK_SIZE;
+            if ((tmp = realloc(buf, cap)) == NULL) {
+                free(buf);
+                errno = -ENOMEM;
+                return -1;
+            }
+
+            buf = tmp;
+        }
+
+        count = read(fd, &buf[len], cap - len);
+        if (count < 0) {
+            free(buf);
+            return -1;
+        }
+
+        if (count == 0) {
+            break;
+        }
+
+        len += count;
+    }
+
+    state->in_buf = buf;
+    state->in_len = len;
+    state->in_mapped = false;
+    state->in_owned = true;
+    return 0;
+}
+
+/*
+ * Release the input source buffer
+ *
+ * @state: Assembler state
+ */
+static void
+arki_state_unload(struct arki_state *state)
+{
+    if (state->in_buf == NULL) {
+        return;
+    }
+
+    if (state->in_mapped) {
+        munmap((void *)state->in_buf, state->in_len);
+    } else if (state->in_owned) {
+        free((void *)state->in_buf);
+    }
+
+    state->in_buf = NULL;
+    state->in_len = 0;
+}
+
+/*
+ * Ensure the output image can hold a number of bytes
+ *
+ * @state: Assembler state
+ * @len:   Length the image must be able to hold
+ *
+ * Returns zero on success
+ */
+static int
+arki_image_reserve(struct arki_state *state, size_t len)
+{
+    uint8_t *tmp;
+    size_t cap;
+
+    if (len <= state->out_cap) {
+        return 0;
+    }
+
+    cap = (state->out_cap == 0) ? len : state->out_cap;
+    while (cap < len) {
+        cap *= 2;
+    }
+
+    if ((tmp = realloc(state->out_buf, cap)) == NULL) {
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    memset(&tmp[state->out_cap], 0, cap - state->out_cap);
+    state->out_buf = tmp;
+    state->out_cap = cap;
+    return 0;
+}
+
+/*
+ * Write bytes straight to the output file
+ *
+ * @state: Assembler state
+ * @off:   Offset into the image
+ * @buf:   Bytes to write
+ * @n:     Number of bytes to write
+ *
+ * Returns zero on success
+ */
+static int
+arki_stream_pwrite(struct arki_state *state, size_t off, const void *buf, size_t n)
+{
+    const uint8_t *p = buf;
+    ssize_t count;
+    uint64_t start;
+
+    start = arki_prof_begin(&state->prof);
+    while (n > 0) {
+        if ((count = pwrite(state->out_fd, p, n, off)) < 0) {
+            arki_prof_end(&state->prof, ARKI_PROF_IO, start);
+            return -1;
+        }
+
+        p += count;
+        off += count;
+        n -= count;
+    }
+
+    arki_prof_end(&state->prof, ARKI_PROF_IO, start);
+    return 0;
+}
+
+/*
+ * Write bytes into a streamed image. Bytes go into the
+ * window while they are in order, anything else flushes it
+ * first. Backpatches that land inside the window stay in
+ * memory.
+ *
+ * @state: Assembler state
+ * @off:   Offset into the image
+ * @buf:   Bytes to write
+ * @n:     Number of bytes to write
+ *
+ * Returns zero on success
+ */
+static int
+arki_stream_write(struct arki_state *state, size_t off, const void *buf, size_t n)
+{
+    size_t end = state->out_base + state->out_pend;
+
+    if (off < state->out_base || off > end || (off + n) > state->out_base + state->out_cap) {
+        if (arki_image_flush(state) < 0) {
+            return -1;
+        }
+
+        /* Too big to be worth buffering */
+        if (n >= state->out_cap) {
+            return arki_stream_pwrite(state, off, buf, n);
+        }
+
+        state->out_base = off;
+        end = off;
+    }
+
+    memcpy(&state->out_buf[off - state->out_base], buf, n);
+    if ((off + n) > end) {
+        state->out_pend = off + n - state->out_base;
+    }
+
+    return 0;
+}
+
 int
-arki_state_init(struct arki_state *state, const char *path, const char *outpath)
+arki_image_flush(struct arki_state *state)
 {
-    if (state == NULL || path == NULL) {
+    if (state == NULL) {
         errno = -EINVAL;
         return -1;
     }
 
-    memset(state, 0, sizeof(*state));
-    if ((state->in_fd = open(path, O_RDONLY)) < 0) {
+    if (!arki_streaming(state) || state->out_pend == 0) {
+        return 0;
+    }
+
+    if (arki_stream_pwrite(state, state->out_base, state->out_buf, state->out_pend) < 0) {
+        return -1;
+    }
+
+    state->out_base += state->out_pend;
+    state->out_pend = 0;
+    return 0;
+}
+
+int
+arki_image_write(struct arki_state *state, size_t off, const void *buf, size_t n)
+{
+    if (state == NULL || buf == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (arki_streaming(state)) {
+        if (arki_stream_write(state, off, buf, n) < 0) {
+            return -1;
+        }
+
+        if ((off + n) > state->out_len) {
+            state->out_len = off + n;
+        }
+
+        return 0;
+    }
+
+    if (arki_image_reserve(state, off + n) < 0) {
         return -1;
     }
 
-    state->out_fd = open(outpath, O_WRONLY | O_TRUNC | O_CREAT, 0666);
-    if (state->out_fd < 0) {
-        close(state->in_fd);
+    memcpy(&state->out_buf[off], buf, n);
+    if ((off + n) > state->out_len) {
+        state->out_len = off + n;
+    }
+
+    return 0;
+}
+
+int
+arki_image_fill(struct arki_state *state, size_t off, uint8_t byte, size_t n)
+{
+    uint8_t buf[INPUT_BLOCK_SIZE];
+    size_t len;
+
+    if (state == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (arki_streaming(state)) {
+        memset(buf, byte, (n < sizeof(buf)) ? n : sizeof(buf));
+        while (n > 0) {
+            len = (n < sizeof(buf)) ? n : sizeof(buf);
+            if (arki_image_write(state, off, buf, len) < 0) {
+                return -1;
+            }
+
+            off += len;
+            n -= len;
+        }
+
+        return 0;
+    }
+
+    if (arki_image_reserve(state, off + n) < 0) {
         return -1;
     }
 
+    memset(&state->out_buf[off], byte, n);
+    if ((off + n) > state->out_len) {
+        state->out_len = off + n;
+    }
+
+    return 0;
+}
+
+int
+arki_image_size(struct arki_state *state, size_t size)
+{
+    if (state == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    /* A streamed image is written in order, nothing to size */
+    if (arki_streaming(state)) {
+        return 0;
+    }
+
+    if (arki_image_fill(state, 0, 0x00, size) < 0) {
+        return -1;
+    }
+
+    state->out_len = 0;
+    return 0;
+}
+
+void
+arki_input_release(struct arki_state *state)
+{
+    size_t len;
+
+    if (state == NULL || !arki_streaming(state) || !state->in_mapped) {
+        return;
+    }
+
+    if ((state->in_pos - state->in_dropped) < STREAM_DROP_SIZE) {
+        return;
+    }
+
+    /*
+     * The mapping starts on a page and the drop size is a
+     * multiple of one. Dropped pages are read back from the
+     * file if a later pass needs them.
+     */
+    len = (state->in_pos - state->in_dropped) & ~((size_t)STREAM_DROP_SIZE - 1);
+    madvise((void *)&state->in_buf[state->in_dropped], len, MADV_DONTNEED);
+    state->in_dropped += len;
+}
+
+int
+arki_state_stream(struct arki_state *state, int fd)
+{
+    if (state == NULL || fd < 0) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if ((state->out_buf = malloc(STREAM_WINDOW_SIZE)) == NULL) {
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    state->out_cap = STREAM_WINDOW_SIZE;
+    state->out_fd = fd;
+    return 0;
+}
+
+/*
+ * Set up everything but the input of an assembler state
+ *
+ * @state: Assembler state
+ *
+ * Returns zero on success
+ */
+static int
+arki_state_setup(struct arki_state *state)
+{
     if (symbol_table_init(&state->symtab) < 0) {
-        close(state->in_fd);
-        close(state->out_fd);
+        arki_state_unload(state);
         return -1;
     }
 
     if (ptrbox_init(&state->ptrbox) < 0) {
-        close(state->in_fd);
-        close(state->out_fd);
+        arki_state_unload(state);
         symbol_table_destroy(&state->symtab);
         return -1;
     }
 
+    fixup_table_init(&state->fixups);
     state->line_num = 1;
+    state->out_fd = -1;
+    return 0;
+}
+
+/*
+ * Copy a run of a file into a streamed image through the
+ * window
+ *
+ * @state:    Assembler state
+ * @off:      Offset into the image
+ * @fd:       File to read from
+ * @file_off: Offset into the file
+ * @n:        Number of bytes to copy
+ *
+ * Returns zero on success
+ */
+static int
+arki_stream_load(struct arki_state *state, size_t off, int fd, off_t file_off, size_t n)
+{
+    uint8_t buf[INPUT_BLOCK_SIZE];
+    ssize_t count;
+
+    while (n > 0) {
+        count = pread(fd, buf, (n < sizeof(buf)) ? n : sizeof(buf), file_off);
+        if (count < 0) {
+            return -1;
+        }
+
+        /* The file shrank since it was sized */
+        if (count == 0) {
+            errno = -EIO;
+            return -1;
+        }
+
+        if (arki_stream_write(state, off, buf, count) < 0) {
+            return -1;
+        }
+
+        file_off += count;
+        off += count;
+        n -= count;
+    }
+
+    return 0;
+}
+
+int
+arki_image_load(struct arki_state *state, size_t off, int fd, off_t file_off, size_t n)
+{
+    ssize_t count;
+    size_t done = 0;
+
+    if (state == NULL || fd < 0) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (arki_streaming(state)) {
+        if (arki_stream_load(state, off, fd, file_off, n) < 0) {
+            return -1;
+        }
+
+        if ((off + n) > state->out_len) {
+            state->out_len = off + n;
+        }
+
+        return 0;
+    }
+
+    if (arki_image_reserve(state, off + n) < 0) {
+        return -1;
+    }
+
+    /* Straight into the image, no staging buffer */
+    while (done < n) {
+        count = pread(fd, &state->out_buf[off + done], n - done, file_off + done);
+        if (count < 0) {
+            return -1;
+        }
+
+        /* The file shrank since it was sized */
+        if (count == 0) {
+            errno = -EIO;
+            return -1;
+        }
+
+        done += count;
+    }
+
+    if ((off + n) > state->out_len) {
+        state->out_len = off + n;
+    }
+
+    return 0;
+}
+
+int
+arki_state_init(struct arki_state *state, const char *path)
+{
+    int fd, error;
+
+    if (state == NULL || path == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    memset(state, 0, sizeof(*state));
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return -1;
+    }
+
+    /* A mapping outlives its file descriptor */
+    error = arki_state_load(state, fd);
+    close(fd);
+    if (error < 0) {
+        return -1;
+    }
+
+    state->in_path = path;
+
+    return arki_state_setup(state);
+}
+
+int
+arki_state_init_buf(struct arki_state *state, const char *buf, size_t len)
+{
+    if (state == NULL || (buf == NULL && len > 0)) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    memset(state, 0, sizeof(*state));
+    state->in_buf = buf;
+    state->in_len = len;
+    return arki_state_setup(state);
+}
+
+int
+arki_state_rewind(struct arki_state *state)
+{
+    if (state == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    symbol_table_destroy(&state->symtab);
+    if (symbol_table_init(&state->symtab) < 0) {
+        return -1;
+    }
+
+    fixup_table_destroy(&state->fixups);
+    state->listing.count = 0;
+    if (state->mov_wide != NULL) {
+        memset(state->mov_wide, 0, state->mov_cap);
+    }
+
+    if (state->out_buf != NULL) {
+        memset(state->out_buf, 0, state->out_cap);
+    }
+
+    /* Drop whatever was streamed out already */
+    if (arki_streaming(state)) {
+        if (ftruncate(state->out_fd, 0) < 0) {
+            return -1;
+        }
+
+        state->out_base = 0;
+        state->out_pend = 0;
+    }
+
+    state->out_len = 0;
+    state->line_num = 1;
+    state->pass_count = 0;
+    state->origin = 0;
+    state->out_size = 0;
+    state->vpc = 0;
+    state->in_pos = 0;
+    state->in_dropped = 0;
+    state->putback = '\0';
+    state->mov_idx = 0;
+    state->label_idx = 0;
+    state->relax_pass = 0;
+    state->unsettled = false;
     return 0;
 }
 
@@ -53,8 +592,16 @@ arki_state_close(struct arki_state *state)
         return;
     }
 
-    close(state->in_fd);
-    close(state->out_fd);
+    free(state->out_buf);
+    state->out_buf = NULL;
+
+    arki_state_unload(state);
     ptrbox_destroy(&state->ptrbox);
     symbol_table_destroy(&state->symtab);
+    fixup_table_destroy(&state->fixups);
+    free(state->mov_wide);
+    state->mov_wide = NULL;
+    list_destroy(&state->listing);
+    free(state->diag);
+    state->diag = NULL;
 }
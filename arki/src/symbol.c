@@ -10,6 +10,96 @@
 #include <errno.h>
 #include "arki/symbol.h"
 
+/* Initial table sizes (must be power-of-two) */
+#define SYMTAB_INIT_SLOTS 64
+#define SYMTAB_INIT_IDS   32
+
+/*
+ * Hash a symbol name (FNV-1a)
+ *
+ * @name: Name to hash
+ */
+static uint32_t
+symbol_hash(const char *name)
+{
+    uint32_t hash = 2166136261U;
+
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/*
+ * Find the hash table slot of a name, either the one
+ * holding it or the free one it would go into
+ *
+ * @table: Symbol table
+ * @name:  Name to look up
+ * @hash:  Hash of name
+ */
+static struct symbol **
+symbol_slot(struct symbol_table *table, const char *name, uint32_t hash)
+{
+    struct symbol **slot;
+    size_t mask, i;
+
+    mask = table->slot_cap - 1;
+    i = hash & mask;
+
+    for (;;) {
+        slot = &table->slots[i];
+        if (*slot == NULL) {
+            return slot;
+        }
+
+        if ((*slot)->hash == hash && strcmp((*slot)->name, name) == 0) {
+            return slot;
+        }
+
+        i = (i + 1) & mask;
+    }
+}
+
+/*
+ * Double the number of hash table slots and rehash
+ *
+ * @table: Symbol table to grow
+ *
+ * Returns zero on success
+ */
+static int
+symbol_table_grow(struct symbol_table *table)
+{
+    struct symbol **old_slots, **slot, *sym;
+    size_t old_cap;
+
+    old_slots = table->slots;
+    old_cap = table->slot_cap;
+
+    table->slots = calloc(old_cap * 2, sizeof(*table->slots));
+    if (table->slots == NULL) {
+        table->slots = old_slots;
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    table->slot_cap = old_cap * 2;
+    for (size_t i = 0; i < old_cap; ++i) {
+        if ((sym = old_slots[i]) == NULL) {
+            continue;
+        }
+
+        slot = symbol_slot(table, sym->name, sym->hash);
+        *slot = sym;
+    }
+
+    free(old_slots);
+    return 0;
+}
+
 int
 symbol_table_init(struct symbol_table *table)
 {
@@ -19,7 +109,22 @@ symbol_table_init(struct symbol_table *table)
     }
 
     table->sym_count = 0;
-    TAILQ_INIT(&table->entries);
+    table->slot_cap = SYMTAB_INIT_SLOTS;
+    table->id_cap = SYMTAB_INIT_IDS;
+
+    table->slots = calloc(table->slot_cap, sizeof(*table->slots));
+    if (table->slots == NULL) {
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    table->by_id = calloc(table->id_cap, sizeof(*table->by_id));
+    if (table->by_id == NULL) {
+        free(table->slots);
+        errno = -ENOMEM;
+        return -1;
+    }
+
     return 0;
 }
 
@@ -27,23 +132,52 @@ int
 symbol_table_new(struct symbol_table *table, const char *name,
     sym_type_t type, struct symbol **res)
 {
-    struct symbol *sym;
+    struct symbol *sym, **slot, **tmp;
 
     if (table == NULL || name == NULL) {
         errno = -EINVAL;
         return -1;
     }
 
+    /* Keep the load factor at or below one half */
+    if ((table->sym_count + 1) * 2 > table->slot_cap) {
+        if (symbol_table_grow(table) < 0)
+            return -1;
+    }
+
+    if (table->sym_count >= table->id_cap) {
+        tmp = realloc(table->by_id, table->id_cap * 2 * sizeof(*tmp));
+        if (tmp == NULL) {
+            errno = -ENOMEM;
+            return -1;
+        }
+
+        table->by_id = tmp;
+        table->id_cap *= 2;
+    }
+
     if ((sym = malloc(sizeof(*sym))) == NULL) {
         errno = -ENOMEM;
         return -1;
     }
 
     memset(sym, 0, sizeof(*sym));
-    sym->name = strdup(name);
+    if ((sym->name = strdup(name)) == NULL) {
+        free(sym);
+        errno = -ENOMEM;
+        return -1;
+    }
+
     sym->type = type;
+    sym->hash = symbol_hash(name);
     sym->id = table->sym_count++;
-    TAILQ_INSERT_TAIL(&table->entries, sym, link);
+    table->by_id[sym->id] = sym;
+
+    /* The first definition of a name wins lookups */
+    slot = symbol_slot(table, sym->name, sym->hash);
+    if (*slot == NULL) {
+        *slot = sym;
+    }
 
     if (res != NULL) {
         *res = sym;
@@ -57,53 +191,43 @@ symbol_table_destroy(struct symbol_table *table)
 {
     struct symbol *sym;
 
-    for (;;) {
-        if ((sym = TAILQ_FIRST(&table->entries)) == NULL) {
-            break;
-        }
+    if (table == NULL) {
+        return;
+    }
 
-        TAILQ_REMOVE(&table->entries, sym, link);
+    for (size_t i = 0; i < table->sym_count; ++i) {
+        sym = table->by_id[i];
         free(sym->name);
         free(sym);
     }
+
+    free(table->slots);
+    free(table->by_id);
+    table->slots = NULL;
+    table->by_id = NULL;
+    table->sym_count = 0;
 }
 
 struct symbol *
 symbol_by_name(struct symbol_table *table, const char *name)
 {
-    struct symbol *sym;
-
-    if (table == NULL) {
+    if (table == NULL || name == NULL) {
         return NULL;
     }
 
-    TAILQ_FOREACH(sym, &table->entries, link) {
-        if (*sym->name != *name) {
-            continue;
-        }
-
-        if (strcmp(sym->name, name) == 0) {
-            return sym;
-        }
-    }
-
-    return NULL;
+    return *symbol_slot(table, name, symbol_hash(name));
 }
 
 struct symbol *
 symbol_by_id(struct symbol_table *table, symid_t id)
 {
-    struct symbol *sym;
-
     if (table == NULL) {
         return NULL;
     }
 
-    TAILQ_FOREACH(sym, &table->entries, link) {
-        if (sym->id == id) {
-            return sym;
-        }
+    if (id < 0 || (size_t)id >= table->sym_count) {
+        return NULL;
     }
 
-    return NULL;
+    return table->by_id[id];
 }
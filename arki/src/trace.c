@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include "arki/trace.h"
+#include "arki/state.h"
+
+void
+arki_diag(struct arki_state *state, const char *fmt, ...)
+{
+    va_list ap;
+    size_t cap;
+    char *tmp;
+    int len;
+
+    va_start(ap, fmt);
+    len = vsnprintf(NULL, 0, fmt, ap);
+    va_end(ap);
+
+    if (len < 0) {
+        return;
+    }
+
+    /* Room for the message and its NUL terminator */
+    cap = state->diag_cap;
+    while (state->diag_len + len + 1 > cap) {
+        cap = (cap == 0) ? 256 : cap * 2;
+    }
+
+    if (cap > state->diag_cap) {
+        if ((tmp = realloc(state->diag, cap)) == NULL) {
+            /* Better printed than lost */
+            va_start(ap, fmt);
+            vprintf(fmt, ap);
+            va_end(ap);
+            return;
+        }
+
+        state->diag = tmp;
+        state->diag_cap = cap;
+    }
+
+    va_start(ap, fmt);
+    vsnprintf(&state->diag[state->diag_len], len + 1, fmt, ap);
+    va_end(ap);
+    state->diag_len += len;
+}
@@ -0,0 +1,48 @@
+;;
+;; Copyright (c) 2026, Ian Moffett.
+;; Provided under the BSD-3 clause.
+;;
+
+;;
+;; Posts two read PRPDs to the SPI descriptor ring with a
+;; single doorbell write. Run by 'make check' in emul with
+;; a media image starting with "CHCK-Y64", it halts with:
+;;     G1 = 0x3436592D4B434843  First qword of the media ("CHCK-Y64")
+;;     G2 = 0x2                 Ring head, both PRPDs consumed
+;;     G3 = 0x0                 SPI control/status, no error
+;;
+
+_start:
+    mov g0, 0x11000A        ;; Chipset registers [SPICTL ring base]
+    mov g1, ring            ;; PRPD ring
+    stq g0, g1              ;; Write it
+
+    mov g0, 0x110012        ;; Chipset registers [SPICTL ring size]
+    mov g1, 0x4             ;; Four slots
+    stw g0, g1              ;; Write it
+
+    mov g0, 0x110016        ;; Chipset registers [SPICTL ring tail]
+    mov g1, 0x2             ;; Two PRPDs posted
+    stw g0, g1              ;; Ring the doorbell
+
+    mov g0, 0x110014        ;; Chipset registers [SPICTL ring head]
+    ldw g2, g0              ;; Read it back
+
+    mov g0, 0x110009        ;; Chipset registers [SPICTL ctlstat]
+    ldb g3, g0              ;; Read it back
+
+    mov g0, 0x100000        ;; Local cache
+    ldq g1, g0              ;; Read back first block
+    hlt
+
+ring:
+ring0_buf:      .byte 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00
+ring0_len:      .byte 0x10, 0x00
+ring0_chipsel:  .byte 0x00
+ring0_write:    .byte 0x00
+ring0_offset:   .byte 0x00, 0x00
+ring1_buf:      .byte 0x10, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00
+ring1_len:      .byte 0x10, 0x00
+ring1_chipsel:  .byte 0x00
+ring1_write:    .byte 0x00
+ring1_offset:   .byte 0x10, 0x00
@@ -0,0 +1,69 @@
+;;
+;; Copyright (c) 2026, Ian Moffett.
+;; Provided under the BSD-3 clause.
+;;
+;; SPI write throughput benchmark, streams fifteen
+;; 0xFFF0 byte PRPDs from external RAM to the microsd
+;; through the descriptor ring, then reads the start of
+;; the payload back with the last slot.
+;;
+;; Run by 'make check' in emul with a scratch media image,
+;; it halts with:
+;;     G2 = 0xF                 Ring head after the writes
+;;     G3 = 0x0                 SPI control/status, no error
+;;     G4 = 0xC0FFEE            Payload read back from the media
+;;
+
+_start:
+    mov g0, 0x110000        ;; Chipset registers
+    ldb g1, g0              ;; Load memctl -> G1
+    or g1, 1                ;; Set CG
+    stb g0, g1              ;; Write it back
+
+    mov g0, 0x116000        ;; Start of payload in external RAM
+    mov g1, 0xC0FFEE        ;; Marker
+    stq g0, g1              ;; Write it
+
+    mov g0, 0x11000A        ;; Chipset registers [SPICTL ring base]
+    mov g1, ring            ;; PRPD ring
+    stq g0, g1              ;; Write it
+
+    mov g0, 0x110012        ;; Chipset registers [SPICTL ring size]
+    mov g1, 0x10            ;; Sixteen slots
+    stw g0, g1              ;; Write it
+
+    mov g0, 0x110016        ;; Chipset registers [SPICTL ring tail]
+    mov g1, 0xF             ;; Fifteen PRPDs posted
+    stw g0, g1              ;; Ring the doorbell
+
+    mov g0, 0x110014        ;; Chipset registers [SPICTL ring head]
+    ldw g2, g0              ;; Read it back
+
+    mov g0, 0x110016        ;; Chipset registers [SPICTL ring tail]
+    mov g1, 0x0             ;; Wrap past the read-back PRPD
+    stw g0, g1              ;; Ring the doorbell
+
+    mov g0, 0x110009        ;; Chipset registers [SPICTL ctlstat]
+    ldb g3, g0              ;; Read it back
+
+    mov g0, 0x100000        ;; Local cache
+    ldq g4, g0              ;; Read back start of payload
+    hlt
+
+ring:
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x60, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00
+    .byte 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00
@@ -0,0 +1,32 @@
+;;
+;; Copyright (c) 2026, Ian Moffett.
+;; Provided under the BSD-3 clause.
+;;
+
+_start:
+    mov g0, 0x110000        ;; Chipset registers
+    ldb g1, g0              ;; Load memctl -> G1
+    or g1, 1                ;; Set CG
+    stb g0, g1              ;; Write it back
+    or g1, 2                ;; Set CE
+    stb g0, g1              ;; Write it back
+
+    mov g2, 0x116000        ;; Main memory
+    mov g3, 0xBEEF          ;; Random word
+    stw g2, g3              ;; Miss, fill line
+    ldw g4, g2              ;; Hit
+
+    mov g2, 0x126000        ;; Same set, next tag
+    stw g2, g3
+    mov g2, 0x136000        ;; Same set, next tag
+    stw g2, g3
+    mov g2, 0x146000        ;; Same set, next tag
+    stw g2, g3
+    mov g2, 0x156000        ;; Same set, evicts 0x116000
+    stw g2, g3
+
+    mov g1, 1               ;; Clear CE, write back dirty lines
+    stb g0, g1
+    mov g2, 0x116000        ;; Main memory
+    ldw g5, g2              ;; Read back uncached -> G5
+    hlt
@@ -0,0 +1,24 @@
+;;
+;; Copyright (c) 2026, Ian Moffett.
+;; Provided under the BSD-3 clause.
+;;
+
+;;
+;; Both forward references start out short, widening the
+;; second one pushes 'near' past 64 KiB which then widens
+;; the first one too.
+;;
+.origin 0xFFF0
+
+_start:
+    mov g0, near            ;; Wide, 0x10004 once settled
+    mov g1, far             ;; Wide, 0x10014 once settled
+    .skip 4
+near:
+    hlt
+    .skip 0xF
+far:
+    hlt
+    mov g2, near            ;; Backward, already wide
+    mov g3, 0x10000         ;; Smallest wide immediate
+    mov g4, 0xFFFF          ;; Largest short immediate
@@ -0,0 +1,23 @@
+;;
+;; Copyright (c) 2026, Ian Moffett.
+;; Provided under the BSD-3 clause.
+;;
+
+;;
+;; Blobs are spliced in from 11.dat, which sits next to
+;; this file. The labels after them must land past the
+;; included bytes in both one and two pass mode.
+;;
+_start:
+    mov g0, tail            ;; Forward reference over the blobs
+    mov g1, words
+    hlt
+
+banner:
+    .incbin "11.dat", 0, 21 ;; "Y-64 incbin test blob"
+words:
+    .incbin "11.dat", 22    ;; Binary tail of the file
+whole:
+    .incbin "11.dat"
+tail:
+    .byte @
@@ -0,0 +1,28 @@
+;;
+;; Copyright (c) 2026, Ian Moffett.
+;; Provided under the BSD-3 clause.
+;;
+
+;;
+;; Alignment is worked out from the address, origin
+;; included. Widening the first mov grows the code in
+;; front of 'isr', which then needs less padding.
+;;
+.origin 0xFFE0
+
+_start:
+    mov g0, isr             ;; Wide once 'isr' is past 64 KiB
+    mov g1, table
+    hlt
+
+    .align 5                ;; 32 byte boundary, NOP padded
+isr:
+    or g0, 1
+    hlt
+
+    .balign 16, 0xFF        ;; 16 byte boundary, 0xFF padded
+table:
+    .byte 1, 2, 3, 4
+    .balign 16              ;; Pads 12 bytes
+    .balign 4               ;; Already aligned, no padding
+    .byte @
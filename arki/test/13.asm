@@ -0,0 +1,23 @@
+;;
+;; Copyright (c) 2026, Ian Moffett.
+;; Provided under the BSD-3 clause.
+;;
+
+;;
+;; Data tables, numbers are laid out little-endian. The
+;; '@' in the middle of the byte list is patched with the
+;; image size once it is known.
+;;
+_start:
+    mov g0, words
+    mov g1, quads
+    hlt
+
+bytes:
+    .byte 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A
+    .byte 1, 22, 255, @, 0xFF_FF, 1_000    ;; Truncated to a byte each
+words:
+    .word 0xBEEF, 0xdead, 65535, 0x1_0001  ;; 0x10001 wraps to 0x0001
+quads:
+    .quad 0xDEADBEEFCAFEBABE, 1234567890123456789
+    .quad 0xFFFFFFFFFFFFFFFF, 0, 42
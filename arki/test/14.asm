@@ -0,0 +1,126 @@
+;;
+;; Copyright (c) 2026, Ian Moffett.
+;; Provided under the BSD-3 clause.
+;;
+
+;;
+;; Register ALU ops and compare-and-branch. Branches are
+;; relative to themselves, forward ones are patched in
+;; single-pass mode once their label is seen.
+;;
+;; Run with 'y64emu -f test/14.asm', it halts with:
+;;     G0 = 0x40                Fill index, stopped at the limit
+;;     G3 = 0x28                ALU result, see below
+;;     G4 = 0x38                Last qword read back from RAM
+;;     G5 = 0x555               Branch outcomes, bit set if taken
+;;     G6 = 0xFFFFFFFFFFFFFFFF  Top bit set, -1 signed
+;;
+;; Every even bit of G5 is a branch that must be taken and
+;; every odd bit one that must not be, so any other value
+;; names the branch that went wrong.
+;;
+
+_start:
+    mov g0, 0x110000        ;; Chipset registers
+    ldb g1, g0              ;; Load memctl -> G1
+    or g1, 1                ;; Set CG
+    stb g0, g1              ;; Write it back
+
+    ;; Store the index of each qword in a RAM buffer
+    mov g0, 0               ;; Index
+    mov g1, 0x40            ;; Limit
+    mov g2, 8               ;; Stride
+fill:
+    mov a0, 0x116000        ;; Buffer in external RAM
+    add a0, g0
+    stq a0, g0
+    add g0, g2
+    bltu g0, g1, fill       ;; Backward, taken until the limit
+    ldq g4, a0              ;; G4 = 0x38
+
+    ;; G3 = (((0x38 | 0x40) & 8) ^ 0x38) - 8
+    mov g3, g4
+    or g3, g1
+    and g3, g2
+    xor g3, g4
+    sub g3, g2
+
+    ;; Operands, A1 = A2 = 1 and G6 = -1
+    mov a1, 1
+    mov a2, a1
+    xor g6, g6
+    sub g6, a1
+    xor g5, g5
+
+    mov a3, 0x1
+    beq a1, a2, beq_t       ;; 1 == 1, taken
+    xor a3, a3
+beq_t:
+    or g5, a3
+
+    mov a3, 0x2
+    beq g6, a1, beq_n       ;; -1 == 1, not taken
+    xor a3, a3
+beq_n:
+    or g5, a3
+
+    mov a3, 0x4
+    bne g6, a1, bne_t       ;; -1 != 1, taken
+    xor a3, a3
+bne_t:
+    or g5, a3
+
+    mov a3, 0x8
+    bne a1, a2, bne_n       ;; 1 != 1, not taken
+    xor a3, a3
+bne_n:
+    or g5, a3
+
+    mov a3, 0x10
+    blt g6, a1, blt_t       ;; -1 < 1, taken
+    xor a3, a3
+blt_t:
+    or g5, a3
+
+    mov a3, 0x20
+    blt a1, g6, blt_n       ;; 1 < -1, not taken
+    xor a3, a3
+blt_n:
+    or g5, a3
+
+    mov a3, 0x40
+    bge a1, g6, bge_t       ;; 1 >= -1, taken
+    xor a3, a3
+bge_t:
+    or g5, a3
+
+    mov a3, 0x80
+    bge g6, a1, bge_n       ;; -1 >= 1, not taken
+    xor a3, a3
+bge_n:
+    or g5, a3
+
+    mov a3, 0x100
+    bltu a1, g6, bltu_t     ;; 1 < 0xFFFFFFFFFFFFFFFF, taken
+    xor a3, a3
+bltu_t:
+    or g5, a3
+
+    mov a3, 0x200
+    bltu g6, a1, bltu_n     ;; 0xFFFFFFFFFFFFFFFF < 1, not taken
+    xor a3, a3
+bltu_n:
+    or g5, a3
+
+    mov a3, 0x400
+    bgeu g6, a1, bgeu_t     ;; 0xFFFFFFFFFFFFFFFF >= 1, taken
+    xor a3, a3
+bgeu_t:
+    or g5, a3
+
+    mov a3, 0x800
+    bgeu a1, g6, bgeu_n     ;; 1 >= 0xFFFFFFFFFFFFFFFF, not taken
+    xor a3, a3
+bgeu_n:
+    or g5, a3
+    hlt
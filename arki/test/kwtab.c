@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+/*
+ * Keyword table self-test, run by 'make check' so that a
+ * keyword added without searching for new hash constants
+ * cannot silently collide with another one.
+ */
+
+#include <stdio.h>
+#include "arki/lexer.h"
+
+int
+main(void)
+{
+    if (lexer_kw_check() < 0) {
+        printf("FAIL keyword table\n");
+        return 1;
+    }
+
+    printf("ok keyword table\n");
+    return 0;
+}
@@ -0,0 +1,582 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include "arki/obj.h"
+
+#define ARKL_VERSION "0.0.1"
+
+/* Default output filename */
+#define DEFAULT_OUT "y64.bin"
+
+/* Largest value a wide move immediate can hold */
+#define IMM48_MAX ((1ULL << 48) - 1)
+
+/*
+ * Represents a loaded object file
+ *
+ * @path:      Path of object file
+ * @buf:       Object file contents
+ * @len:       Length of object file
+ * @hdr:       Object header
+ * @sects:     Section table
+ * @syms:      Symbol table
+ * @relocs:    Relocation table
+ * @strtab:    String table
+ * @sect_addr: Link address of each section
+ */
+struct link_obj {
+    const char *path;
+    uint8_t *buf;
+    size_t len;
+    const struct obj_hdr *hdr;
+    const struct obj_sect *sects;
+    const struct obj_sym *syms;
+    const struct obj_reloc *relocs;
+    const char *strtab;
+    uint64_t *sect_addr;
+};
+
+/*
+ * Represents a global symbol
+ *
+ * @name: Symbol name
+ * @addr: Link address of symbol
+ * @obj:  Object defining the symbol
+ */
+struct link_sym {
+    const char *name;
+    uint64_t addr;
+    const struct link_obj *obj;
+};
+
+/* Output file name */
+static const char *out_path = DEFAULT_OUT;
+
+/* Link base address, set by '-b' */
+static uint64_t base;
+static int base_set = 0;
+
+/* Objects being linked */
+static struct link_obj *objs;
+static size_t obj_count;
+
+/* Global symbols sorted by name */
+static struct link_sym *gsyms;
+static size_t gsym_count;
+
+/* Linked image */
+static uint8_t *image;
+static size_t image_size;
+
+static void
+help(void)
+{
+    printf(
+        "ARK-L linker for Y-64\n"
+        "Usage: arkl <object files>\n"
+        "-----------------------------\n"
+        "[-h]   Display this help menu\n"
+        "[-v]   Display the version\n"
+        "[-o]   Output file name\n"
+        "[-b]   Base address of image\n"
+    );
+}
+
+static void
+version(void)
+{
+    printf(
+        "ARK-L linker for Y-64\n"
+        "Copyright (c) 2026 Ian Moffett\n"
+        "------------------------------\n"
+        "ARK-L version v%s\n",
+        ARKL_VERSION
+    );
+}
+
+/*
+ * Check that a table lies within an object file
+ *
+ * @obj:   Object file
+ * @off:   File offset of table
+ * @count: Number of entries
+ * @size:  Size of each entry
+ */
+static int
+link_in_bounds(struct link_obj *obj, size_t off, size_t count, size_t size)
+{
+    if (off > obj->len) {
+        return 0;
+    }
+
+    return count <= (obj->len - off) / size;
+}
+
+/*
+ * Get a name from the string table of an object
+ *
+ * @obj: Object file
+ * @off: String table offset
+ *
+ * Returns NULL if the name is out of bounds
+ */
+static const char *
+link_str(const struct link_obj *obj, uint32_t off)
+{
+    if (off >= obj->hdr->str_size) {
+        return NULL;
+    }
+
+    if (memchr(&obj->strtab[off], '\0', obj->hdr->str_size - off) == NULL) {
+        return NULL;
+    }
+
+    return &obj->strtab[off];
+}
+
+/*
+ * Read an object file into memory and validate it
+ *
+ * @obj:  Object to load into
+ * @path: Path of object file
+ *
+ * Returns zero on success
+ */
+static int
+link_load(struct link_obj *obj, const char *path)
+{
+    const struct obj_hdr *hdr;
+    const struct obj_sect *sect;
+    struct stat st;
+    ssize_t count;
+    size_t done = 0;
+    int fd;
+
+    obj->path = path;
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        perror(path);
+        return -1;
+    }
+
+    if (fstat(fd, &st) < 0 || (obj->buf = malloc(st.st_size + 1)) == NULL) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+
+    obj->len = st.st_size;
+    while (done < obj->len) {
+        if ((count = read(fd, &obj->buf[done], obj->len - done)) <= 0) {
+            perror(path);
+            close(fd);
+            return -1;
+        }
+
+        done += count;
+    }
+
+    close(fd);
+    if (obj->len < sizeof(*hdr)) {
+        printf("[error]: %s: truncated object\n", path);
+        return -1;
+    }
+
+    hdr = obj->hdr = (const struct obj_hdr *)obj->buf;
+    if (memcmp(hdr->magic, OBJ_MAGIC, sizeof(hdr->magic)) != 0) {
+        printf("[error]: %s: not an object file\n", path);
+        return -1;
+    }
+
+    if (hdr->version != OBJ_VERSION) {
+        printf("[error]: %s: bad object version %d\n", path, hdr->version);
+        return -1;
+    }
+
+    if (!link_in_bounds(obj, hdr->sect_off, hdr->sect_count, sizeof(*obj->sects)) ||
+        !link_in_bounds(obj, hdr->sym_off, hdr->sym_count, sizeof(*obj->syms)) ||
+        !link_in_bounds(obj, hdr->reloc_off, hdr->reloc_count, sizeof(*obj->relocs)) ||
+        !link_in_bounds(obj, hdr->str_off, hdr->str_size, 1)) {
+        printf("[error]: %s: corrupt object\n", path);
+        return -1;
+    }
+
+    obj->sects = (const struct obj_sect *)&obj->buf[hdr->sect_off];
+    obj->syms = (const struct obj_sym *)&obj->buf[hdr->sym_off];
+    obj->relocs = (const struct obj_reloc *)&obj->buf[hdr->reloc_off];
+    obj->strtab = (const char *)&obj->buf[hdr->str_off];
+
+    for (uint32_t i = 0; i < hdr->sect_count; ++i) {
+        sect = &obj->sects[i];
+        if (!link_in_bounds(obj, sect->off, sect->size, 1) || link_str(obj, sect->name) == NULL) {
+            printf("[error]: %s: corrupt section %d\n", path, i);
+            return -1;
+        }
+
+        if (sect->align == 0 || (sect->align & (sect->align - 1)) != 0) {
+            printf("[error]: %s: bad section alignment\n", path);
+            return -1;
+        }
+    }
+
+    for (uint32_t i = 0; i < hdr->sym_count; ++i) {
+        if (link_str(obj, obj->syms[i].name) == NULL) {
+            printf("[error]: %s: corrupt symbol %d\n", path, i);
+            return -1;
+        }
+
+        if (obj->syms[i].sect != OBJ_SECT_UNDEF && obj->syms[i].sect >= hdr->sect_count) {
+            printf("[error]: %s: corrupt symbol %d\n", path, i);
+            return -1;
+        }
+    }
+
+    obj->sect_addr = calloc(hdr->sect_count + 1, sizeof(*obj->sect_addr));
+    if (obj->sect_addr == NULL) {
+        perror("calloc");
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Lay out every section, grouping sections of the same name
+ * in order of first appearance, and objects in command line
+ * order within a group.
+ *
+ * Returns zero on success
+ */
+static int
+link_layout(void)
+{
+    const char **names, *name;
+    const struct obj_sect *sect;
+    struct link_obj *obj;
+    size_t name_count = 0, cap = 0, k;
+    uint64_t cursor = 0;
+
+    /* The first object asking for a load address gets it */
+    for (size_t i = 0; i < obj_count && !base_set; ++i) {
+        if ((objs[i].hdr->flags & OBJ_F_ORIGIN) != 0) {
+            base = objs[i].hdr->origin;
+            base_set = 1;
+        }
+    }
+
+    for (size_t i = 0; i < obj_count; ++i) {
+        cap += objs[i].hdr->sect_count;
+    }
+
+    if ((names = calloc(cap + 1, sizeof(*names))) == NULL) {
+        perror("calloc");
+        return -1;
+    }
+
+    /* Collect distinct section names */
+    for (size_t i = 0; i < obj_count; ++i) {
+        for (uint32_t j = 0; j < objs[i].hdr->sect_count; ++j) {
+            name = link_str(&objs[i], objs[i].sects[j].name);
+            for (k = 0; k < name_count; ++k) {
+                if (strcmp(names[k], name) == 0) {
+                    break;
+                }
+            }
+
+            if (k == name_count) {
+                names[name_count++] = name;
+            }
+        }
+    }
+
+    for (k = 0; k < name_count; ++k) {
+        for (size_t i = 0; i < obj_count; ++i) {
+            obj = &objs[i];
+            for (uint32_t j = 0; j < obj->hdr->sect_count; ++j) {
+                sect = &obj->sects[j];
+                if (strcmp(link_str(obj, sect->name), names[k]) != 0) {
+                    continue;
+                }
+
+                cursor = (cursor + sect->align - 1) & ~((uint64_t)sect->align - 1);
+                obj->sect_addr[j] = base + cursor;
+                cursor += sect->size;
+            }
+        }
+    }
+
+    free(names);
+    image_size = cursor;
+    return 0;
+}
+
+/*
+ * Compare two global symbols by name
+ */
+static int
+link_sym_cmp(const void *a, const void *b)
+{
+    const struct link_sym *sa = a, *sb = b;
+
+    return strcmp(sa->name, sb->name);
+}
+
+/*
+ * Collect every defined symbol into the global symbol table
+ *
+ * Returns zero on success
+ */
+static int
+link_symbols(void)
+{
+    const struct obj_sym *sym;
+    struct link_sym *gsym;
+    size_t cap = 0;
+
+    for (size_t i = 0; i < obj_count; ++i) {
+        cap += objs[i].hdr->sym_count;
+    }
+
+    if ((gsyms = calloc(cap + 1, sizeof(*gsyms))) == NULL) {
+        perror("calloc");
+        return -1;
+    }
+
+    for (size_t i = 0; i < obj_count; ++i) {
+        for (uint32_t j = 0; j < objs[i].hdr->sym_count; ++j) {
+            sym = &objs[i].syms[j];
+            if (sym->sect == OBJ_SECT_UNDEF) {
+                continue;
+            }
+
+            gsym = &gsyms[gsym_count++];
+            gsym->name = link_str(&objs[i], sym->name);
+            gsym->addr = objs[i].sect_addr[sym->sect] + sym->value;
+            gsym->obj = &objs[i];
+        }
+    }
+
+    qsort(gsyms, gsym_count, sizeof(*gsyms), link_sym_cmp);
+    for (size_t i = 1; i < gsym_count; ++i) {
+        if (strcmp(gsyms[i - 1].name, gsyms[i].name) == 0) {
+            printf(
+                "[error]: multiple definition of '%s' in %s and %s\n",
+                gsyms[i].name,
+                gsyms[i - 1].obj->path,
+                gsyms[i].obj->path
+            );
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Resolve the address of a symbol referenced by an object
+ *
+ * @obj:  Object making the reference
+ * @idx:  Symbol index within object
+ * @res:  Address is written here
+ *
+ * Returns zero on success
+ */
+static int
+link_resolve(const struct link_obj *obj, uint32_t idx, uint64_t *res)
+{
+    const struct obj_sym *sym;
+    struct link_sym key, *gsym;
+
+    if (idx >= obj->hdr->sym_count) {
+        printf("[error]: %s: bad relocation symbol %d\n", obj->path, idx);
+        return -1;
+    }
+
+    sym = &obj->syms[idx];
+    if (sym->sect != OBJ_SECT_UNDEF) {
+        *res = obj->sect_addr[sym->sect] + sym->value;
+        return 0;
+    }
+
+    key.name = link_str(obj, sym->name);
+    gsym = bsearch(&key, gsyms, gsym_count, sizeof(*gsyms), link_sym_cmp);
+    if (gsym == NULL) {
+        printf("[error]: %s: undefined reference to '%s'\n", obj->path, key.name);
+        return -1;
+    }
+
+    *res = gsym->addr;
+    return 0;
+}
+
+/*
+ * Copy every section into the image and apply relocations
+ *
+ * Returns zero on success
+ */
+static int
+link_image(void)
+{
+    const struct obj_reloc *reloc;
+    const struct obj_sect *sect;
+    struct link_obj *obj;
+    uint64_t value;
+    uint8_t *p;
+
+    if ((image = calloc(image_size + 1, 1)) == NULL) {
+        perror("calloc");
+        return -1;
+    }
+
+    for (size_t i = 0; i < obj_count; ++i) {
+        obj = &objs[i];
+        for (uint32_t j = 0; j < obj->hdr->sect_count; ++j) {
+            sect = &obj->sects[j];
+            memcpy(&image[obj->sect_addr[j] - base], &obj->buf[sect->off], sect->size);
+        }
+
+        for (uint32_t j = 0; j < obj->hdr->reloc_count; ++j) {
+            reloc = &obj->relocs[j];
+            if (reloc->sect >= obj->hdr->sect_count) {
+                printf("[error]: %s: bad relocation section\n", obj->path);
+                return -1;
+            }
+
+            sect = &obj->sects[reloc->sect];
+            p = &image[obj->sect_addr[reloc->sect] - base + reloc->off];
+
+            switch (reloc->type) {
+            case OBJ_RELOC_IMM48:
+                if (reloc->off > sect->size || sect->size - reloc->off < 6) {
+                    printf("[error]: %s: relocation out of bounds\n", obj->path);
+                    return -1;
+                }
+
+                if (link_resolve(obj, reloc->sym, &value) < 0) {
+                    return -1;
+                }
+
+                if (value > IMM48_MAX) {
+                    printf("[error]: %s: address %jx out of range\n", obj->path, (uintmax_t)value);
+                    return -1;
+                }
+
+                for (int k = 0; k < 6; ++k) {
+                    p[k] = (value >> (k * 8)) & 0xFF;
+                }
+
+                break;
+            case OBJ_RELOC_SIZE8:
+                if (reloc->off >= sect->size) {
+                    printf("[error]: %s: relocation out of bounds\n", obj->path);
+                    return -1;
+                }
+
+                *p = image_size & 0xFF;
+                break;
+            default:
+                printf("[error]: %s: bad relocation type %d\n", obj->path, reloc->type);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Write the linked image to the output file
+ *
+ * Returns zero on success
+ */
+static int
+link_write(void)
+{
+    size_t done = 0;
+    ssize_t count;
+    int fd;
+
+    fd = open(out_path, O_WRONLY | O_TRUNC | O_CREAT, 0666);
+    if (fd < 0) {
+        perror(out_path);
+        return -1;
+    }
+
+    while (done < image_size) {
+        if ((count = write(fd, &image[done], image_size - done)) < 0) {
+            perror(out_path);
+            close(fd);
+            return -1;
+        }
+
+        done += count;
+    }
+
+    close(fd);
+    return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hvo:b:")) != -1) {
+        switch (opt) {
+        case 'h':
+            help();
+            return -1;
+        case 'v':
+            version();
+            return -1;
+        case 'o':
+            out_path = optarg;
+            break;
+        case 'b':
+            base = strtoull(optarg, NULL, 0);
+            base_set = 1;
+            break;
+        }
+    }
+
+    if (optind >= argc) {
+        printf("fatal: expected object files\n");
+        help();
+        return -1;
+    }
+
+    obj_count = argc - optind;
+    if ((objs = calloc(obj_count, sizeof(*objs))) == NULL) {
+        perror("calloc");
+        return -1;
+    }
+
+    for (size_t i = 0; i < obj_count; ++i) {
+        if (link_load(&objs[i], argv[optind + i]) < 0) {
+            return -1;
+        }
+    }
+
+    if (link_layout() < 0) {
+        return -1;
+    }
+
+    if (link_symbols() < 0) {
+        return -1;
+    }
+
+    if (link_image() < 0) {
+        return -1;
+    }
+
+    return (link_write() < 0) ? -1 : 0;
+}
@@ -0,0 +1,7 @@
+;;
+;; Copyright (c) 2026, Ian Moffett.
+;; Provided under the BSD-3 clause.
+;;
+
+message:
+    .byte 0x48, 0x49, 0x00
@@ -0,0 +1,23 @@
+;;
+;; Copyright (c) 2026, Ian Moffett.
+;; Provided under the BSD-3 clause.
+;;
+
+;;
+;; Links against data.asm, 'make check' does this and
+;; compares the image with main.hex:
+;;     arki -c -o out test/main.asm test/data.asm
+;;     arkl -o y64.bin out/main.o out/data.o
+;;
+.origin 0x1000
+
+_start:
+    mov g0, message         ;; Defined in data.asm
+    mov g1, local           ;; Defined below
+    ldb g2, g0
+    stb g1, g2
+    hlt
+local:
+    .byte 0x00
+image_size:
+    .byte @
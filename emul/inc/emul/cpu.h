@@ -8,36 +8,24 @@
 
 #include <sys/queue.h>
 #include <stdint.h>
-#include "emul/balloon.h"
+#include <stdbool.h>
+#include "emul/lcache.h"
 #include "emul/defs.h"
-
-/* Maximum local cache size */
-#define DOMAIN_CACHE_SIZE 65536
+#include "arki/isa.h"
 
 /* Address of lcache MMIO */
 #define DOMAIN_LCACHE_BASE 0x00100000
-#define DOMAIN_LCACHE_SIZE 0x1000
-
-/* Valid opcodes */
-#define OPCODE_NOP   0x00        /* No-operation [A] */
-#define OPCODE_IMOV  0x01        /* Move wide IMM [C] */
-#define OPCODE_IMOVS 0x03        /* Move short IMM [D] */
-#define OPCODE_IADD  0x05        /* IMM register ADD [D] */
-#define OPCODE_ISUB  0x07        /* IMM register SUB [D] */
-#define OPCODE_HLT   0x0D        /* Halt [A] */
-#define OPCODE_SRR   0x0E        /* Special register read [A] */
-#define OPCODE_SRW   0x0F        /* Special register write [A] */
-#define OPCODE_IOR   0x10        /* IMM bitwise OR [D] */
-#define OPCODE_LITR  0x14        /* Load ITR [E] */
-#define OPCODE_STB   0x15        /* Store byte [B] */
-#define OPCODE_STW   0x16        /* Store word [B] */
-#define OPCODE_STL   0x17        /* Store dword [B] */
-#define OPCODE_STQ   0x18        /* Store qword [B] */
-#define OPCODE_LDB   0x19        /* Load byte [B] */
-#define OPCODE_LDW   0x1A        /* Load word [B] */
-#define OPCODE_LDL   0x1B        /* Load dword [B] */
-#define OPCODE_LDQ   0x1C        /* Load qword [B] */
-#define OPCODE_B     0x1D        /* Indirect branch [E] */
+#define DOMAIN_LCACHE_SIZE 0x10000
+
+/* Valid opcodes as OPCODE_<name>, see arki/isa.h */
+#define CPU_OPCODE_ENUM(name, opcode, fmt, flags, desc) \
+    OPCODE_##name = (opcode),
+
+enum {
+    ISA_INSTS(CPU_OPCODE_ENUM)
+};
+
+#undef CPU_OPCODE_ENUM
 
 /* Error syndrome types */
 #define ESR_MAV  0x01           /* Memory access violation */
@@ -114,6 +102,9 @@ struct PACKED ist_entry {
     uint16_t zero1 : 15;
 };
 
+/* Forward declaration */
+struct cpu_timing;
+
 /*
  * Represents a processing domain (PD)
  *
@@ -125,22 +116,31 @@ struct PACKED ist_entry {
  * @sync_vec:  Pending synchronous interrupt vector
  * @n_cycles:  Number of cycles completed
  * @sreg:      Special registers
+ * @timing:    Timing model, NULL if disabled
+ * @symmap:    Symbol map, NULL if none
+ * @trace:     Trace every cycle with a register dump
  */
 struct cpu_domain {
     uint32_t domain_id;
-    struct balloon_mem cache;
+    struct lcache cache;
     uint64_t regbank[REG_MAX];
     uint64_t itr;
     uint64_t esr;
     uint8_t sync_vec;
     size_t n_cycles;
     uint64_t sreg[SREG_MAX];
+    struct cpu_timing *timing;
+    struct symmap *symmap;
+    bool trace;
 };
 
 /*
  * Power-up a processing domain
+ *
+ * @cpu:    PD to power up
+ * @n_ways: Local cache associativity
  */
-int cpu_power_up(struct cpu_domain *cpu);
+int cpu_power_up(struct cpu_domain *cpu, size_t n_ways);
 
 /*
  * Raise an interrupt on a specific PD
@@ -11,6 +11,7 @@
 
 /* Compiler attributes */
 #define PACKED  __attribute__((packed))
+#define ALIGN(n) __attribute__((aligned(n)))
 
 /* Helper macros */
 #define NELEM(a) (sizeof(a) / sizeof(a[0]))
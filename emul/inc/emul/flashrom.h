@@ -25,4 +25,20 @@
  */
 ssize_t flashrom_flash(const void *buf, size_t n);
 
+/*
+ * Map a firmware image file directly into the flash ROM
+ * window without copying it
+ *
+ * @fd: File descriptor of the image
+ * @n:  Size of the image in bytes
+ *
+ * Returns zero on success
+ */
+int flashrom_map(int fd, size_t n);
+
+/*
+ * Release the flash ROM and any image mapped into it
+ */
+void flashrom_destroy(void);
+
 #endif  /* !EMUL_FLASHROM_H */
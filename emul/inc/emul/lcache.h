@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#ifndef EMUL_LCACHE_H
+#define EMUL_LCACHE_H 1
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "emul/balloon.h"
+#include "emul/defs.h"
+
+/* Local cache size */
+#define DOMAIN_CACHE_SIZE 65536
+
+/* Cache line size (must be power-of-two) */
+#define LCACHE_LINE_SIZE 64
+#define LCACHE_LINE_COUNT (DOMAIN_CACHE_SIZE / LCACHE_LINE_SIZE)
+
+/* Associativity bounds */
+#define LCACHE_MAX_WAYS 16
+#define LCACHE_DEFAULT_WAYS 4
+
+/*
+ * Represents the state of a single cache line
+ *
+ * @tag:   Tag of the cached external RAM line
+ * @stamp: Last access stamp used for LRU replacement
+ * @valid: Line holds data
+ * @dirty: Line has been written since it was filled
+ */
+struct lcache_line {
+    uintptr_t tag;
+    uint64_t stamp;
+    bool valid;
+    bool dirty;
+};
+
+/*
+ * Represents the PD local cache unit
+ *
+ * While CE is de-asserted the cache is used as RAM and the
+ * data array is addressed directly through the lcache MMIO
+ * window. Once CE is asserted the data array holds lines of
+ * external RAM organized in sets of @n_ways lines each.
+ *
+ * @data:      Data array
+ * @lines:     Line state, indexed as [set * n_ways + way]
+ * @n_ways:    Number of ways per set
+ * @n_sets:    Number of sets
+ * @clock:     Access clock used for LRU stamps
+ * @enabled:   Set if CE is asserted
+ * @hits:      Number of line hits while caching
+ * @misses:    Number of line misses while caching
+ * @evictions: Number of valid lines replaced while caching
+ */
+struct lcache {
+    uint8_t data[DOMAIN_CACHE_SIZE] ALIGN(LCACHE_LINE_SIZE);
+    struct lcache_line lines[LCACHE_LINE_COUNT];
+    size_t n_ways;
+    size_t n_sets;
+    uint64_t clock;
+    bool enabled;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+};
+
+/*
+ * Initialize a local cache in cache-as-RAM mode
+ *
+ * @lc:     Local cache to initialize
+ * @n_ways: Number of ways per set
+ *
+ * Returns zero on success
+ */
+int lcache_init(struct lcache *lc, size_t n_ways);
+
+/*
+ * Read from the local cache used as RAM
+ *
+ * @lc:   Local cache
+ * @off:  Offset into the data array
+ * @buf:  Buffer to read into
+ * @n:    Number of bytes to read
+ *
+ * Returns the number of bytes read on success, fails
+ * while CE is asserted.
+ */
+ssize_t lcache_car_read(struct lcache *lc, uintptr_t off, void *buf, size_t n);
+
+/*
+ * Write to the local cache used as RAM
+ *
+ * @lc:   Local cache
+ * @off:  Offset into the data array
+ * @buf:  Buffer to write
+ * @n:    Number of bytes to write
+ *
+ * Returns the number of bytes written on success, fails
+ * while CE is asserted.
+ */
+ssize_t lcache_car_write(struct lcache *lc, uintptr_t off, const void *buf, size_t n);
+
+/*
+ * Read external RAM through the cache
+ *
+ * @lc:      Local cache
+ * @backing: External RAM backing the cache
+ * @addr:    RAM address to read
+ * @buf:     Buffer to read into
+ * @n:       Number of bytes to read
+ *
+ * Returns the number of bytes read on success
+ */
+ssize_t lcache_read(
+    struct lcache *lc, struct balloon_mem *backing,
+    uintptr_t addr, void *buf, size_t n
+);
+
+/*
+ * Write external RAM through the cache
+ *
+ * @lc:      Local cache
+ * @backing: External RAM backing the cache
+ * @addr:    RAM address to write
+ * @buf:     Buffer to write
+ * @n:       Number of bytes to write
+ *
+ * Returns the number of bytes written on success
+ */
+ssize_t lcache_write(
+    struct lcache *lc, struct balloon_mem *backing,
+    uintptr_t addr, const void *buf, size_t n
+);
+
+/*
+ * Assert CE, discarding the cache-as-RAM contents
+ *
+ * @lc: Local cache
+ */
+void lcache_enable(struct lcache *lc);
+
+/*
+ * De-assert CE, writing back all dirty lines
+ *
+ * @lc:      Local cache
+ * @backing: External RAM backing the cache
+ *
+ * Returns zero on success
+ */
+int lcache_disable(struct lcache *lc, struct balloon_mem *backing);
+
+/*
+ * Dump hit, miss and eviction counters
+ *
+ * @lc: Local cache
+ */
+void lcache_dump_stats(struct lcache *lc);
+
+#endif  /* !EMUL_LCACHE_H */
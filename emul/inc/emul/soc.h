@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include "emul/cpu.h"
 #include "emul/balloon.h"
+#include "emul/spictl.h"
 #include "emul/defs.h"
 
 #define MAIN_MEMORY_START   0x116000
@@ -18,6 +19,7 @@
 
 /* Chipset memory control */
 #define CS_MEMCTL_CG (1 << 0)   /* Cache gate */
+#define CS_MEMCTL_CE (1 << 1)   /* Cache enable */
 
 /*
  * SPI control registers used to talk with the
@@ -25,10 +27,12 @@
  *
  * @prpd: Physical region page descriptor
  * @ctlstat: Control and status register
+ * @ring: PRPD descriptor ring
  */
 struct PACKED spi_ctl {
     uintptr_t prpd;
     uint8_t ctlstat;
+    struct spi_ring ring;
 };
 
 /*
@@ -59,9 +63,11 @@ struct soc_desc {
 /*
  * Power up a system on chip
  *
- * @soc: SoC descriptor
+ * @soc:    SoC descriptor
+ * @memcap: Capacity of main memory in bytes
+ * @n_ways: Local cache associativity
  */
-int soc_power_up(struct soc_desc *soc, size_t memcap);
+int soc_power_up(struct soc_desc *soc, size_t memcap, size_t n_ways);
 
 /*
  * Destroy a system on chip
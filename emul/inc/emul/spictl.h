@@ -13,6 +13,7 @@
 
 /* SPI status bits */
 #define SPICTL_BUSY  (1 << 1)
+#define SPICTL_ERR   (1 << 2)
 
 /* SPI device IDs */
 #define SPI_MICROSD 0x00
@@ -20,6 +21,9 @@
 /* SPI block size (must be power-of-two) */
 #define SPI_BLOCK_SIZE 16
 
+/* Number of pooled SPI blocks per device */
+#define SPI_POOL_BLOCKS 256
+
 typedef uint8_t spi_id_t;
 
 /*
@@ -54,6 +58,22 @@ struct PACKED spi_prpd {
     uint16_t offset;
 };
 
+/*
+ * SPI descriptor ring registers, used to post many PRPDs
+ * to the controller with a single doorbell write.
+ *
+ * @base: Physical base address of the PRPD ring
+ * @size: Number of PRPD slots within the ring
+ * @head: Index of the next PRPD to be consumed by the controller
+ * @tail: Doorbell, index one past the last PRPD posted by software
+ */
+struct PACKED spi_ring {
+    uintptr_t base;
+    uint16_t size;
+    uint16_t head;
+    uint16_t tail;
+};
+
 /*
  * Represents an SPI endpoint device that may have
  * transactions fowarded
@@ -62,14 +82,19 @@ struct PACKED spi_prpd {
  * @recv:   Callback to get data from device
  * @flush:  Callback to flush block queue
  * @evict:  Evict all entries
+ * @bulk:   Callback to flush a contiguous payload [optional]
  * @blockq: List of blocks to be processed
+ * @freeq:  List of free blocks, the pool itself is kept by
+ *          the bus for registered devices only
  */
 struct spi_slave {
     spi_id_t id;
     void(*recv)(struct spi_slave *slave, struct spi_prpd *prpd);
     void(*flush)(struct spi_slave *slave, off_t off);
     void(*evict)(struct spi_slave *slave);
+    void(*bulk)(struct spi_slave *slave, const void *buf, size_t n, off_t off);
     TAILQ_HEAD(, spi_block) blockq;
+    TAILQ_HEAD(, spi_block) freeq;
 };
 
 /*
@@ -93,6 +118,23 @@ struct PACKED chipset_spictl {
  */
 int spi_register_device(spi_id_t id, struct spi_slave *device);
 
+/*
+ * Take a block from the pool of an SPI device
+ *
+ * @slave: Device to take a block from
+ *
+ * Returns NULL if the pool is exhausted
+ */
+struct spi_block *spi_block_alloc(struct spi_slave *slave);
+
+/*
+ * Return a block to the pool of an SPI device
+ *
+ * @slave: Device the block was taken from
+ * @block: Block to return
+ */
+void spi_block_free(struct spi_slave *slave, struct spi_block *block);
+
 /*
  * Send data to an SPI device
  *
@@ -111,4 +153,21 @@ int spi_write(struct spi_prpd *prpd);
  */
 int spi_read(struct spi_prpd *prpd);
 
+/*
+ * Process every PRPD posted to a descriptor ring between
+ * the head and the tail, advancing the head as they complete.
+ *
+ * @ring: Descriptor ring registers
+ *
+ * Returns zero on success, on failure the head is left
+ * at the descriptor that could not be completed.
+ */
+int spi_ring_process(struct spi_ring *ring);
+
+/*
+ * Returns the total number of bytes moved over the
+ * SPI bus so far
+ */
+size_t spi_xfer_count(void);
+
 #endif  /* !EMUL_SPICTL_H */
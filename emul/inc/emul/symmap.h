@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#ifndef EMUL_SYMMAP_H
+#define EMUL_SYMMAP_H 1
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "arki/map.h"
+
+/* Routines shown in the profile */
+#define SYMMAP_TOP_COUNT 10
+
+/*
+ * Represents a symbol map written by arki, the map is used
+ * in place and searched by address on every sample.
+ *
+ * @base:      Start of map
+ * @size:      Size of map
+ * @mapped:    Set if the map was mapped from a file
+ * @syms:      Symbols sorted by address
+ * @sym_count: Number of symbols
+ * @strtab:    Symbol names
+ * @str_size:  Size of 'strtab'
+ * @samples:   Samples taken per symbol
+ * @unknown:   Samples that hit no symbol
+ */
+struct symmap {
+    void *base;
+    size_t size;
+    bool mapped;
+    const struct map_sym *syms;
+    uint32_t sym_count;
+    const char *strtab;
+    uint32_t str_size;
+    uint64_t *samples;
+    uint64_t unknown;
+};
+
+/*
+ * Map a symbol map file
+ *
+ * @sm:   Symbol map to initialize
+ * @path: Path of map file
+ *
+ * Returns zero on success
+ */
+int symmap_open(struct symmap *sm, const char *path);
+
+/*
+ * Use a symbol map already in memory, the buffer must
+ * outlive the symbol map
+ *
+ * @sm:  Symbol map to initialize
+ * @buf: Map contents
+ * @len: Length of map
+ *
+ * Returns zero on success
+ */
+int symmap_init(struct symmap *sm, const void *buf, size_t len);
+
+/*
+ * Find the symbol an address falls within
+ *
+ * @sm:   Symbol map
+ * @addr: Address to look up
+ *
+ * Returns the symbol on success, otherwise NULL
+ */
+const struct map_sym *symmap_lookup(struct symmap *sm, uint64_t addr);
+
+/*
+ * Get the name of a symbol
+ *
+ * @sm:  Symbol map
+ * @sym: Symbol from 'sm'
+ */
+const char *symmap_name(struct symmap *sm, const struct map_sym *sym);
+
+/*
+ * Print an address as symbol+offset
+ *
+ * @sm:   Symbol map
+ * @addr: Address to print
+ */
+void symmap_print(struct symmap *sm, uint64_t addr);
+
+/*
+ * Count a profiling sample against the routine an
+ * address falls within
+ *
+ * @sm:   Symbol map
+ * @addr: Sampled address
+ */
+void symmap_sample(struct symmap *sm, uint64_t addr);
+
+/*
+ * Report the routines that took the most samples
+ *
+ * @sm: Symbol map
+ */
+void symmap_report(struct symmap *sm);
+
+/*
+ * Release a symbol map
+ *
+ * @sm: Symbol map
+ */
+void symmap_close(struct symmap *sm);
+
+#endif  /* !EMUL_SYMMAP_H */
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#ifndef EMUL_TIMING_H
+#define EMUL_TIMING_H 1
+
+#include <stdint.h>
+#include <stddef.h>
+#include "emul/lcache.h"
+
+/*
+ * Represents the state of the cycle-approximate timing
+ * model. A PD only pays for timing when one is attached.
+ *
+ * @cycles:    Estimated cycles elapsed
+ * @insts:     Instructions retired
+ * @lc_hits:   Local cache hits already accounted for
+ * @lc_misses: Local cache misses already accounted for
+ * @spi_bytes: SPI bytes already accounted for
+ */
+struct cpu_timing {
+    uint64_t cycles;
+    uint64_t insts;
+    size_t lc_hits;
+    size_t lc_misses;
+    size_t spi_bytes;
+};
+
+/*
+ * Initialize a timing model
+ *
+ * @tp: Timing model to initialize
+ */
+void timing_init(struct cpu_timing *tp);
+
+/*
+ * Account for a retired instruction
+ *
+ * @tp:     Timing model
+ * @opcode: Opcode of the instruction
+ */
+void timing_inst(struct cpu_timing *tp, uint8_t opcode);
+
+/*
+ * Account for a completed memory access
+ *
+ * @tp:   Timing model
+ * @lc:   Local cache of the accessing PD
+ * @addr: Address that was accessed
+ */
+void timing_access(struct cpu_timing *tp, struct lcache *lc, uintptr_t addr);
+
+/*
+ * Report estimated cycles and IPC
+ *
+ * @tp: Timing model
+ */
+void timing_report(struct cpu_timing *tp);
+
+#endif  /* !EMUL_TIMING_H */
@@ -91,11 +91,11 @@ balloon_read(struct balloon_mem *bp, uintptr_t addr, void *buf, size_t n)
     /* Does this overlap past the expansion point? */
     if ((addr + n) >= bp->cur_size) {
         dest = (char *)buf;
-        memcpy(buf, &bp->buf[addr], bp->cur_size);
+        memcpy(buf, &bp->buf[addr], bp->cur_size - addr);
 
         pad_len = (addr + n) - bp->cur_size;
-        memset(&dest[bp->cur_size], 0, pad_len);
-        return 0;
+        memset(&dest[bp->cur_size - addr], 0, pad_len);
+        return n;
     }
 
     memcpy(buf, &bp->buf[addr], n);
@@ -20,7 +20,7 @@ static struct bus_peer_range memmap[] = {
     /* PD local cache */
     {
         .start = 0x00100000,
-        .end   = 0x00101000,
+        .end   = 0x00110000,
         .peer  = NULL
     },
 
@@ -4,10 +4,13 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <errno.h>
 #include <stddef.h>
 #include <string.h>
 #include "emul/cpu.h"
+#include "emul/timing.h"
+#include "emul/symmap.h"
 #include "emul/trace.h"
 #include "emul/busctl.h"
 #include "emul/memctl.h"
@@ -49,6 +52,11 @@ static uint64_t sreg_masktab[] = {
 };
 #undef sreg_index
 
+/* Opcode table generated from the ISA description */
+static const struct isa_inst cpu_optab[ISA_OPCODE_MAX] = {
+    ISA_INSTS(ISA_INST_ENTRY)
+};
+
 /*
  * Read a special register
  *
@@ -104,7 +112,7 @@ cpu_sreg_write(struct cpu_domain *cpu, sreg_t reg, uint64_t v)
 }
 
 static ssize_t
-lcache_write(struct bus_peer *bp, uintptr_t addr, const void *buf, size_t n)
+lcache_peer_write(struct bus_peer *bp, uintptr_t addr, const void *buf, size_t n)
 {
     struct cpu_domain *cpu;
 
@@ -113,7 +121,7 @@ lcache_write(struct bus_peer *bp, uintptr_t addr, const void *buf, size_t n)
         return -1;
     }
 
-    return balloon_write(
+    return lcache_car_write(
         &cpu->cache,
         bus_peer_mmio(DOMAIN_LCACHE_BASE, addr),
         buf,
@@ -122,7 +130,7 @@ lcache_write(struct bus_peer *bp, uintptr_t addr, const void *buf, size_t n)
 }
 
 static ssize_t
-lcache_read(struct bus_peer *bp, uintptr_t addr, void *buf, size_t n)
+lcache_peer_read(struct bus_peer *bp, uintptr_t addr, void *buf, size_t n)
 {
     struct cpu_domain *cpu;
 
@@ -131,7 +139,7 @@ lcache_read(struct bus_peer *bp, uintptr_t addr, void *buf, size_t n)
         return -1;
     }
 
-    return balloon_read(
+    return lcache_car_read(
         &cpu->cache,
         bus_peer_mmio(DOMAIN_LCACHE_BASE, addr),
         buf,
@@ -171,8 +179,8 @@ cpu_decode_ctype(struct cpu_domain *cpu, inst_t *inst)
         return;
     }
 
-    rd = (inst->raw >> 8) & 0xFF;
-    imm = (inst->raw >> 16) & 0xFFFFFFFFFFFF;
+    rd = ISA_RD(inst->raw);
+    imm = ISA_IMM(inst->raw, ISA_IMM_BITS_C);
 
     /* Is this a valid register? */
     if (rd >= REG_MAX) {
@@ -204,8 +212,8 @@ cpu_decode_dtype(struct cpu_domain *cpu, inst_t *inst)
         return;
     }
 
-    rd = (inst->raw >> 8) & 0xFF;
-    imm = (inst->raw >> 16) & 0xFFFF;
+    rd = ISA_RD(inst->raw);
+    imm = ISA_IMM(inst->raw, ISA_IMM_BITS_D);
 
     /* Is this a valid register? */
     if (rd >= REG_MAX) {
@@ -239,7 +247,7 @@ cpu_decode_etype(struct cpu_domain *cpu, inst_t *inst)
         return;
     }
 
-    rs = (inst->raw >> 8) & 0xFF;
+    rs = ISA_RD(inst->raw);
 
     /* Is the source register valid? */
     if (rs >= REG_MAX) {
@@ -258,6 +266,68 @@ cpu_decode_etype(struct cpu_domain *cpu, inst_t *inst)
     }
 }
 
+/*
+ * Decode an F-type instruction, a compare-and-branch. PC
+ * is moved by the displacement if taken and past the
+ * branch otherwise.
+ *
+ * @cpu:  Current PD
+ * @inst: Instruction to decode
+ */
+static void
+cpu_decode_ftype(struct cpu_domain *cpu, inst_t *inst)
+{
+    uint64_t a, b;
+    reg_t ra, rb;
+    bool taken;
+
+    if (cpu == NULL || inst == NULL) {
+        return;
+    }
+
+    ra = ISA_RD(inst->raw);
+    rb = ISA_RS(inst->raw);
+
+    if (ra >= REG_MAX || rb >= REG_MAX) {
+        cpu->esr = ESR_PV;
+        cpu_raise_int(cpu, IVEC_SYNC);
+        return;
+    }
+
+    a = cpu->regbank[ra];
+    b = cpu->regbank[rb];
+
+    switch (inst->opcode) {
+    case OPCODE_BEQ:
+        taken = a == b;
+        break;
+    case OPCODE_BNE:
+        taken = a != b;
+        break;
+    case OPCODE_BLT:
+        taken = (int64_t)a < (int64_t)b;
+        break;
+    case OPCODE_BGE:
+        taken = (int64_t)a >= (int64_t)b;
+        break;
+    case OPCODE_BLTU:
+        taken = a < b;
+        break;
+    case OPCODE_BGEU:
+        taken = a >= b;
+        break;
+    default:
+        taken = false;
+        break;
+    }
+
+    if (taken) {
+        cpu->regbank[REG_PC] += ISA_DISP(inst->raw);
+    } else {
+        cpu->regbank[REG_PC] += ISA_LEN_F;
+    }
+}
+
 /*
  * Read a special register
  *
@@ -298,6 +368,31 @@ cpu_srw(struct cpu_domain *cpu)
     );
 }
 
+/*
+ * Decode an A-type instruction
+ *
+ * @cpu:  Current PD
+ * @inst: Instruction to decode
+ */
+static void
+cpu_decode_atype(struct cpu_domain *cpu, inst_t *inst)
+{
+    if (cpu == NULL || inst == NULL) {
+        return;
+    }
+
+    switch (inst->opcode) {
+    case OPCODE_NOP:
+        break;
+    case OPCODE_SRR:
+        cpu_srr(cpu);
+        break;
+    case OPCODE_SRW:
+        cpu_srw(cpu);
+        break;
+    }
+}
+
 /*
  * Service an interrupt vector
  *
@@ -389,6 +484,10 @@ cpu_mem_write(struct cpu_domain *cpu, uintptr_t addr, const void *buf, size_t n)
         return -1;
     }
 
+    if (cpu->timing != NULL) {
+        timing_access(cpu->timing, &cpu->cache, addr);
+    }
+
     return count;
 }
 
@@ -425,6 +524,10 @@ cpu_mem_read(struct cpu_domain *cpu, uintptr_t addr, void *buf, size_t n)
         return -1;
     }
 
+    if (cpu->timing != NULL) {
+        timing_access(cpu->timing, &cpu->cache, addr);
+    }
+
     return count;
 }
 
@@ -444,8 +547,8 @@ cpu_decode_btype(struct cpu_domain *cpu, inst_t *inst)
     }
 
     /* Extract destination and source regs */
-    rd = (inst->raw >> 8) & 0xFF;
-    rs = (inst->raw >> 16) & 0xFF;
+    rd = ISA_RD(inst->raw);
+    rs = ISA_RS(inst->raw);
 
     if (rd >= REG_MAX || rs >= REG_MAX) {
         cpu->esr = ESR_PV;
@@ -454,6 +557,24 @@ cpu_decode_btype(struct cpu_domain *cpu, inst_t *inst)
     }
 
     switch (inst->opcode) {
+    case OPCODE_MOV:
+        cpu->regbank[rd] = cpu->regbank[rs];
+        break;
+    case OPCODE_ADD:
+        cpu->regbank[rd] += cpu->regbank[rs];
+        break;
+    case OPCODE_SUB:
+        cpu->regbank[rd] -= cpu->regbank[rs];
+        break;
+    case OPCODE_OR:
+        cpu->regbank[rd] |= cpu->regbank[rs];
+        break;
+    case OPCODE_AND:
+        cpu->regbank[rd] &= cpu->regbank[rs];
+        break;
+    case OPCODE_XOR:
+        cpu->regbank[rd] ^= cpu->regbank[rs];
+        break;
     case OPCODE_STB:
         cpu_mem_write(
             cpu,
@@ -571,7 +692,7 @@ cpu_dump(struct cpu_domain *cpu)
 }
 
 int
-cpu_power_up(struct cpu_domain *cpu)
+cpu_power_up(struct cpu_domain *cpu, size_t n_ways)
 {
     int error;
 
@@ -587,8 +708,9 @@ cpu_power_up(struct cpu_domain *cpu)
         return -1;
     }
 
-    error = balloon_new(&cpu->cache, 32, DOMAIN_CACHE_SIZE);
+    error = lcache_init(&cpu->cache, n_ways);
     if (error < 0) {
+        trace_error("bad lcache associativity %zu\n", n_ways);
         return -1;
     }
 
@@ -599,7 +721,9 @@ cpu_power_up(struct cpu_domain *cpu)
 void
 cpu_run(struct cpu_domain *cpu)
 {
+    const struct isa_inst *op;
     ssize_t count;
+    uint64_t pc;
     inst_t inst;
 
     if (cpu == NULL) {
@@ -607,55 +731,49 @@ cpu_run(struct cpu_domain *cpu)
     }
 
     for (;;) {
-        count = mem_read(cpu->regbank[REG_PC], &inst, sizeof(inst));
+        pc = cpu->regbank[REG_PC];
+        count = mem_read(pc, &inst, sizeof(inst));
         if (count < 0) {
             trace_error("instruction fetch failure\n");
             return;
         }
 
-        switch (inst.opcode) {
-        case OPCODE_NOP:
-            cpu->regbank[REG_PC] += 1;
-            break;
-        case OPCODE_HLT:
+        if (cpu->symmap != NULL) {
+            symmap_sample(cpu->symmap, pc);
+        }
+
+        if (cpu->timing != NULL) {
+            timing_access(cpu->timing, &cpu->cache, cpu->regbank[REG_PC]);
+        }
+
+        op = &cpu_optab[inst.opcode];
+        if (op->flags & ISA_F_HALT) {
+            if (cpu->timing != NULL) {
+                timing_inst(cpu->timing, inst.opcode);
+            }
+
             printf("[*] processor halted\n");
             return;
-        case OPCODE_SRR:
-            cpu_srr(cpu);
-            cpu->regbank[REG_PC] += 1;
+        }
+
+        switch (op->fmt) {
+        case ISA_FMT_A:
+            cpu_decode_atype(cpu, &inst);
             break;
-        case OPCODE_SRW:
-            cpu_srw(cpu);
-            cpu->regbank[REG_PC] += 1;
+        case ISA_FMT_B:
+            cpu_decode_btype(cpu, &inst);
             break;
-        case OPCODE_IMOV:
+        case ISA_FMT_C:
             cpu_decode_ctype(cpu, &inst);
-            cpu->regbank[REG_PC] += 8;
-            break;
-        case OPCODE_STB:
-        case OPCODE_STW:
-        case OPCODE_STL:
-        case OPCODE_STQ:
-        case OPCODE_LDB:
-        case OPCODE_LDW:
-        case OPCODE_LDL:
-        case OPCODE_LDQ:
-            cpu_decode_btype(cpu, &inst);
-            cpu->regbank[REG_PC] += 3;
             break;
-        case OPCODE_IADD:
-        case OPCODE_IMOVS:
-        case OPCODE_ISUB:
-        case OPCODE_IOR:
+        case ISA_FMT_D:
             cpu_decode_dtype(cpu, &inst);
-            cpu->regbank[REG_PC] += 4;
             break;
-        case OPCODE_LITR:
+        case ISA_FMT_E:
             cpu_decode_etype(cpu, &inst);
-            cpu->regbank[REG_PC] += 2;
             break;
-        case OPCODE_B:
-            cpu_decode_etype(cpu, &inst);
+        case ISA_FMT_F:
+            cpu_decode_ftype(cpu, &inst);
             break;
         default:
             cpu->esr = ESR_UD;
@@ -664,8 +782,28 @@ cpu_run(struct cpu_domain *cpu)
             continue;
         }
 
-        printf("[*] cycle %zd completed\n", cpu->n_cycles++);
-        cpu_dump(cpu);
+        /* Jumps leave PC where they pointed it */
+        if (!(op->flags & ISA_F_JUMP)) {
+            cpu->regbank[REG_PC] += op->len;
+        }
+
+        if (cpu->timing != NULL) {
+            timing_inst(cpu->timing, inst.opcode);
+        }
+
+        /* Terminal I/O here would dominate any loop, opt-in only */
+        if (cpu->trace) {
+            printf("[*] cycle %zd completed", cpu->n_cycles);
+            if (cpu->symmap != NULL) {
+                printf(" at ");
+                symmap_print(cpu->symmap, pc);
+            }
+
+            printf("\n");
+            cpu_dump(cpu);
+        }
+
+        ++cpu->n_cycles;
         cpu_poll_sync(cpu);
     }
 }
@@ -677,11 +815,14 @@ cpu_destroy(struct cpu_domain *cpu)
         return;
     }
 
-    balloon_destroy(&cpu->cache);
+    /* The cache is embedded, just detach it from the bus */
+    if (lcache_peer.data == cpu) {
+        lcache_peer.data = NULL;
+    }
 }
 
 static struct bus_peer lcache_peer = {
     .type = BUS_PEER_LCACHE,
-    .read = lcache_read,
-    .write = lcache_write
+    .read = lcache_peer_read,
+    .write = lcache_peer_write
 };
@@ -3,8 +3,8 @@
  * Provided under the BSD-3 clause.
  */
 
-#include <sys/mman.h>
 #include <stdio.h>
+#include <stdbool.h>
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -12,6 +12,10 @@
 #include "emul/soc.h"
 #include "emul/trace.h"
 #include "emul/balloon.h"
+#include "emul/lcache.h"
+#include "emul/timing.h"
+#include "emul/symmap.h"
+#include "arki/libarki.h"
 #include "emul/memctl.h"
 #include "emul/flashrom.h"
 #include "emul/microsd.h"
@@ -21,7 +25,11 @@
 
 static const char *sd_path = NULL;
 static const char *firmware_path = NULL;
+static const char *map_path = NULL;
 static size_t ram_cap = DEFAULT_MEM_CAP;
+static size_t lcache_ways = LCACHE_DEFAULT_WAYS;
+static bool timing_enabled = false;
+static bool trace_enabled = false;
 
 static void
 help(void)
@@ -31,9 +39,13 @@ help(void)
         "------------------------------\n"
         "[-h]   Display this help menu\n"
         "[-v]   Display the version\n"
-        "[-f]   Firmware ROM file\n"
+        "[-f]   Firmware ROM file (or .asm source)\n"
         "[-r]   Maximum RAM in GiB\n"
         "[-s]   Insert microsd media\n"
+        "[-a]   Local cache associativity (ways)\n"
+        "[-t]   Estimate cycles with the timing model\n"
+        "[-m]   Symbol map for traces and profiling\n"
+        "[-d]   Trace every cycle with a register dump\n"
     );
 }
 
@@ -72,58 +84,148 @@ flashrom_dump(void)
     }
 }
 
+/*
+ * Returns true if a firmware path names an assembly
+ * source rather than an image
+ *
+ * @path: Firmware path
+ */
+static bool
+firmware_is_asm(const char *path)
+{
+    size_t len = strlen(path);
+
+    return len > 4 && strcmp(&path[len - 4], ".asm") == 0;
+}
+
+/*
+ * Map a firmware image file into the flash ROM
+ *
+ * @path: Path of image
+ * @fd:   Descriptor of the image is written here
+ *
+ * Returns zero on success
+ */
+static int
+firmware_map(const char *path, int *fd)
+{
+    off_t fw_size;
+
+    if ((*fd = open(path, O_RDONLY)) < 0) {
+        trace_error("failed to open firmware ROM\n");
+        perror("open");
+        return -1;
+    }
+
+    /* Obtain the size */
+    fw_size = lseek(*fd, 0, SEEK_END);
+    lseek(*fd, 0, SEEK_SET);
+
+    if (fw_size <= 0 || fw_size > BIOS_FLASHROM_SIZE) {
+        trace_error("fatal: firmware overflow\n");
+        return -1;
+    }
+
+    /* Map the image straight into the flash ROM */
+    if (flashrom_map(*fd, fw_size) < 0) {
+        trace_error("failed to map BIOS ROM\n");
+        perror("mmap");
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Assemble a firmware source in-process and flash the
+ * image into the flash ROM
+ *
+ * @path: Path of source
+ * @res:  Assembler result, keeps the symbol map around
+ *
+ * Returns zero on success
+ */
+static int
+firmware_assemble(const char *path, struct arki_result *res)
+{
+    struct arki_options opts;
+
+    memset(&opts, 0, sizeof(opts));
+    opts.map = true;
+    if (arki_assemble_file(path, &opts, res) < 0) {
+        trace_error("failed to assemble %s\n", path);
+        if (res->diag != NULL) {
+            fputs(res->diag, stdout);
+        } else {
+            perror("arki_assemble_file");
+        }
+
+        return -1;
+    }
+
+    if (res->image_len == 0 || res->image_len > BIOS_FLASHROM_SIZE) {
+        trace_error("fatal: firmware overflow\n");
+        return -1;
+    }
+
+    if (flashrom_flash(res->image, res->image_len) < 0) {
+        trace_error("failed to flash BIOS ROM\n");
+        return -1;
+    }
+
+    return 0;
+}
+
 static void
 emul_run(void)
 {
-    void *fw_buf;
     struct cpu_domain *cpu;
+    struct cpu_timing timing;
+    struct symmap symmap;
+    struct arki_result asm_res;
     struct soc_desc soc;
-    size_t fw_size;
-    int fw_fd;
+    int fw_fd = -1;
+    int error;
 
-    if (soc_power_up(&soc, ram_cap) < 0) {
+    if (soc_power_up(&soc, ram_cap, lcache_ways) < 0) {
         trace_error("failed to perform soc power-up\n");
         return;
     }
 
     cpu = &soc.cpu;
-    fw_fd = open(firmware_path, O_RDONLY);
+    cpu->trace = trace_enabled;
 
-    if (fw_fd < 0) {
-        trace_error("failed to open firmware ROM\n");
-        perror("open");
-        return;
+    if (timing_enabled) {
+        timing_init(&timing);
+        cpu->timing = &timing;
     }
 
-    /* Obtain the size */
-    fw_size = lseek(fw_fd, 0, SEEK_END);
-    lseek(fw_fd, 0, SEEK_SET);
+    if (map_path != NULL) {
+        if (symmap_open(&symmap, map_path) < 0) {
+            trace_error("failed to load symbol map %s\n", map_path);
+            soc_destroy(&soc);
+            return;
+        }
 
-    if (fw_size >= DOMAIN_CACHE_SIZE) {
-        trace_error("fatal: firmware overflow\n");
-        close(fw_fd);
-        return;
+        cpu->symmap = &symmap;
     }
 
-    /* Map the file */
-    fw_buf = mmap(
-        NULL,
-        fw_size,
-        PROT_READ,
-        MAP_SHARED,
-        fw_fd,
-        0
-    );
+    memset(&asm_res, 0, sizeof(asm_res));
+    if (firmware_is_asm(firmware_path)) {
+        error = firmware_assemble(firmware_path, &asm_res);
+    } else {
+        error = firmware_map(firmware_path, &fw_fd);
+    }
 
-    if (fw_buf == NULL) {
-        trace_error("failed to open firmware ROM\n");
-        perror("mmap");
+    if (error < 0) {
         goto done;
     }
 
-    if (flashrom_flash(fw_buf, fw_size) < 0) {
-        trace_error("failed to flash BIOS ROM\n");
-        goto done;
+    /* Symbolize with the assembler's labels unless given a map */
+    if (cpu->symmap == NULL && asm_res.map != NULL) {
+        if (symmap_init(&symmap, asm_res.map, asm_res.map_len) == 0) {
+            cpu->symmap = &symmap;
+        }
     }
 
     /* Insert microsd media if we can */
@@ -135,9 +237,27 @@ emul_run(void)
     printf("[*] dumping bootstrap pd state\n");
     cpu_dump(cpu);
     cpu_run(cpu);
+    printf("[*] dumping final pd state\n");
+    cpu_dump(cpu);
+    lcache_dump_stats(&cpu->cache);
+    if (timing_enabled) {
+        timing_report(&timing);
+    }
+
+    if (cpu->symmap != NULL) {
+        symmap_report(cpu->symmap);
+    }
 done:
-    munmap(fw_buf, fw_size);
-    close(fw_fd);
+    if (cpu->symmap != NULL) {
+        symmap_close(cpu->symmap);
+    }
+
+    flashrom_destroy();
+    arki_result_free(&asm_res);
+    if (fw_fd >= 0) {
+        close(fw_fd);
+    }
+
     soc_destroy(&soc);
 }
 
@@ -146,7 +266,7 @@ main(int argc, char **argv)
 {
     int opt;
 
-    while ((opt = getopt(argc, argv, "hvf:r:s:")) != -1) {
+    while ((opt = getopt(argc, argv, "hvtdf:r:s:a:m:")) != -1) {
         switch (opt) {
         case 'h':
             help();
@@ -163,6 +283,18 @@ main(int argc, char **argv)
         case 's':
             sd_path = strdup(optarg);
             break;
+        case 'a':
+            lcache_ways = atoi(optarg);
+            break;
+        case 't':
+            timing_enabled = true;
+            break;
+        case 'd':
+            trace_enabled = true;
+            break;
+        case 'm':
+            map_path = strdup(optarg);
+            break;
         }
     }
 
@@ -3,16 +3,22 @@
  * Provided under the BSD-3 clause.
  */
 
+#include <sys/mman.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
 #include <errno.h>
 #include "emul/flashrom.h"
-#include "emul/balloon.h"
 #include "emul/busctl.h"
 
-/* Maximum capacity of flash ROM */
-#define FLASHROM_CAP 0x100000
-
-/* Actual flash ROM */
-static struct balloon_mem flashrom;
+/*
+ * Actual flash ROM, a read-only mapping covering the
+ * whole flash ROM window. Firmware images are mapped
+ * over the start of it, anything past the image reads
+ * back as zero.
+ */
+static uint8_t *flashrom = NULL;
+static bool is_init = false;
 
 /* Bus control operations */
 static struct bus_peer flashrom_peer;
@@ -20,30 +26,65 @@ static struct bus_peer flashrom_peer;
 static ssize_t
 flashrom_read(struct bus_peer *bp, uintptr_t addr, void *buf, size_t n)
 {
+    uintptr_t off;
+    size_t len;
+
     if (bp == NULL || buf == NULL) {
         errno = -EINVAL;
         return -1;
     }
 
-    return balloon_read(
-        &flashrom,
-        bus_peer_mmio(BIOS_FLASHROM_START, addr),
-        buf,
-        n
-    );
+    if (flashrom == NULL) {
+        errno = -EIO;
+        return -1;
+    }
+
+    /*
+     * Reads that run off the end of the window are clamped
+     * to it, the rest reads back as zero just like the part
+     * of the window past the image.
+     */
+    off = bus_peer_mmio(BIOS_FLASHROM_START, addr);
+    len = 0;
+    if (off < BIOS_FLASHROM_SIZE) {
+        len = BIOS_FLASHROM_SIZE - off;
+        len = (n < len) ? n : len;
+        memcpy(buf, &flashrom[off], len);
+    }
+
+    memset((uint8_t *)buf + len, 0, n - len);
+    return n;
 }
 
 static int
 flashrom_init(void)
 {
-    if (balloon_new(&flashrom, 8, FLASHROM_CAP) < 0) {
+    flashrom = mmap(
+        NULL,
+        BIOS_FLASHROM_SIZE,
+        PROT_READ,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+
+    if (flashrom == MAP_FAILED) {
+        flashrom = NULL;
+        errno = -ENOMEM;
         return -1;
     }
 
+    if (is_init) {
+        return 0;
+    }
+
     if (bus_peer_set(&flashrom_peer, BIOS_FLASHROM_START) < 0) {
+        munmap(flashrom, BIOS_FLASHROM_SIZE);
+        flashrom = NULL;
         return -1;
     }
 
+    is_init = true;
     return 0;
 }
 
@@ -55,17 +96,71 @@ flashrom_flash(const void *buf, size_t n)
         return -1;
     }
 
-    if (flashrom.buf == NULL) {
+    if (n > BIOS_FLASHROM_SIZE) {
+        errno = -EFBIG;
+        return -1;
+    }
+
+    if (flashrom == NULL) {
         if (flashrom_init() < 0)
             return -1;
     }
 
-    return balloon_write(
-        &flashrom,
-        0,
-        buf,
-        n
+    if (mprotect(flashrom, BIOS_FLASHROM_SIZE, PROT_READ | PROT_WRITE) < 0) {
+        return -1;
+    }
+
+    memcpy(flashrom, buf, n);
+    mprotect(flashrom, BIOS_FLASHROM_SIZE, PROT_READ);
+    return n;
+}
+
+int
+flashrom_map(int fd, size_t n)
+{
+    void *mem;
+
+    if (fd < 0 || n == 0) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (n > BIOS_FLASHROM_SIZE) {
+        errno = -EFBIG;
+        return -1;
+    }
+
+    if (flashrom == NULL) {
+        if (flashrom_init() < 0)
+            return -1;
+    }
+
+    /* Place the image over the start of the window */
+    mem = mmap(
+        flashrom,
+        n,
+        PROT_READ,
+        MAP_PRIVATE | MAP_FIXED,
+        fd,
+        0
     );
+
+    if (mem == MAP_FAILED) {
+        return -1;
+    }
+
+    return 0;
+}
+
+void
+flashrom_destroy(void)
+{
+    if (flashrom == NULL) {
+        return;
+    }
+
+    munmap(flashrom, BIOS_FLASHROM_SIZE);
+    flashrom = NULL;
 }
 
 static struct bus_peer flashrom_peer = {
@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include "emul/lcache.h"
+#include "emul/balloon.h"
+
+/* Line number and offset of an external RAM address */
+#define lcache_lineno(addr) ((addr) / LCACHE_LINE_SIZE)
+#define lcache_lineoff(addr) ((addr) & (LCACHE_LINE_SIZE - 1))
+
+/*
+ * Returns a pointer to the data of a cache line
+ *
+ * @lc:    Local cache
+ * @index: Index of line
+ */
+static inline uint8_t *
+lcache_line_data(struct lcache *lc, size_t index)
+{
+    return &lc->data[index * LCACHE_LINE_SIZE];
+}
+
+/*
+ * Write a dirty line back to external RAM
+ *
+ * @lc:      Local cache
+ * @backing: External RAM
+ * @index:   Index of line to write back
+ *
+ * Returns zero on success
+ */
+static int
+lcache_writeback(struct lcache *lc, struct balloon_mem *backing, size_t index)
+{
+    struct lcache_line *line;
+    uintptr_t addr;
+    ssize_t count;
+
+    line = &lc->lines[index];
+    if (!line->valid || !line->dirty) {
+        return 0;
+    }
+
+    /* Rebuild the line address from the tag and set */
+    addr = (line->tag * lc->n_sets) + (index / lc->n_ways);
+    addr *= LCACHE_LINE_SIZE;
+
+    count = balloon_write(
+        backing,
+        addr,
+        lcache_line_data(lc, index),
+        LCACHE_LINE_SIZE
+    );
+
+    if (count < 0) {
+        return -1;
+    }
+
+    line->dirty = false;
+    return 0;
+}
+
+/*
+ * Look up the line caching an external RAM address, filling
+ * it from external RAM on a miss
+ *
+ * @lc:      Local cache
+ * @backing: External RAM
+ * @addr:    Address to look up
+ *
+ * Returns the line index on success, otherwise a less
+ * than zero value
+ */
+static ssize_t
+lcache_lookup(struct lcache *lc, struct balloon_mem *backing, uintptr_t addr)
+{
+    struct lcache_line *line;
+    uintptr_t lineno, tag;
+    size_t set, base, victim;
+    ssize_t count;
+
+    lineno = lcache_lineno(addr);
+    set = lineno % lc->n_sets;
+    tag = lineno / lc->n_sets;
+    base = set * lc->n_ways;
+    victim = base;
+
+    ++lc->clock;
+    for (size_t i = base; i < base + lc->n_ways; ++i) {
+        line = &lc->lines[i];
+        if (line->valid && line->tag == tag) {
+            line->stamp = lc->clock;
+            ++lc->hits;
+            return i;
+        }
+
+        /* Prefer free lines, then the least recently used */
+        if (!lc->lines[victim].valid) {
+            continue;
+        }
+
+        if (!line->valid || line->stamp < lc->lines[victim].stamp) {
+            victim = i;
+        }
+    }
+
+    ++lc->misses;
+    line = &lc->lines[victim];
+
+    if (line->valid) {
+        if (lcache_writeback(lc, backing, victim) < 0)
+            return -1;
+
+        ++lc->evictions;
+    }
+
+    count = balloon_read(
+        backing,
+        lineno * LCACHE_LINE_SIZE,
+        lcache_line_data(lc, victim),
+        LCACHE_LINE_SIZE
+    );
+
+    if (count < 0) {
+        line->valid = false;
+        return -1;
+    }
+
+    line->tag = tag;
+    line->stamp = lc->clock;
+    line->valid = true;
+    line->dirty = false;
+    return victim;
+}
+
+int
+lcache_init(struct lcache *lc, size_t n_ways)
+{
+    if (lc == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    /* Ways must be a power-of-two */
+    if (n_ways == 0 || n_ways > LCACHE_MAX_WAYS) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if ((n_ways & (n_ways - 1)) != 0) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    memset(lc, 0, sizeof(*lc));
+    lc->n_ways = n_ways;
+    lc->n_sets = LCACHE_LINE_COUNT / n_ways;
+    return 0;
+}
+
+ssize_t
+lcache_car_read(struct lcache *lc, uintptr_t off, void *buf, size_t n)
+{
+    if (lc == NULL || buf == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (lc->enabled || (off + n) > DOMAIN_CACHE_SIZE) {
+        errno = -EIO;
+        return -1;
+    }
+
+    memcpy(buf, &lc->data[off], n);
+    return n;
+}
+
+ssize_t
+lcache_car_write(struct lcache *lc, uintptr_t off, const void *buf, size_t n)
+{
+    if (lc == NULL || buf == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (lc->enabled || (off + n) > DOMAIN_CACHE_SIZE) {
+        errno = -EIO;
+        return -1;
+    }
+
+    memcpy(&lc->data[off], buf, n);
+    return n;
+}
+
+ssize_t
+lcache_read(struct lcache *lc, struct balloon_mem *backing, uintptr_t addr,
+    void *buf, size_t n)
+{
+    uint8_t *dest = buf;
+    size_t len, done = 0;
+    ssize_t index;
+
+    if (lc == NULL || backing == NULL || buf == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    while (done < n) {
+        if ((index = lcache_lookup(lc, backing, addr + done)) < 0) {
+            errno = -EIO;
+            return -1;
+        }
+
+        len = LCACHE_LINE_SIZE - lcache_lineoff(addr + done);
+        if (len > n - done) {
+            len = n - done;
+        }
+
+        memcpy(
+            &dest[done],
+            lcache_line_data(lc, index) + lcache_lineoff(addr + done),
+            len
+        );
+
+        done += len;
+    }
+
+    return n;
+}
+
+ssize_t
+lcache_write(struct lcache *lc, struct balloon_mem *backing, uintptr_t addr,
+    const void *buf, size_t n)
+{
+    const uint8_t *src = buf;
+    size_t len, done = 0;
+    ssize_t index;
+
+    if (lc == NULL || backing == NULL || buf == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    while (done < n) {
+        if ((index = lcache_lookup(lc, backing, addr + done)) < 0) {
+            errno = -EIO;
+            return -1;
+        }
+
+        len = LCACHE_LINE_SIZE - lcache_lineoff(addr + done);
+        if (len > n - done) {
+            len = n - done;
+        }
+
+        memcpy(
+            lcache_line_data(lc, index) + lcache_lineoff(addr + done),
+            &src[done],
+            len
+        );
+
+        lc->lines[index].dirty = true;
+        done += len;
+    }
+
+    return n;
+}
+
+void
+lcache_enable(struct lcache *lc)
+{
+    if (lc == NULL || lc->enabled) {
+        return;
+    }
+
+    memset(lc->lines, 0, sizeof(lc->lines));
+    lc->enabled = true;
+}
+
+int
+lcache_disable(struct lcache *lc, struct balloon_mem *backing)
+{
+    if (lc == NULL || backing == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (!lc->enabled) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < LCACHE_LINE_COUNT; ++i) {
+        if (lcache_writeback(lc, backing, i) < 0)
+            return -1;
+    }
+
+    memset(lc->lines, 0, sizeof(lc->lines));
+    lc->enabled = false;
+    return 0;
+}
+
+void
+lcache_dump_stats(struct lcache *lc)
+{
+    size_t total;
+
+    if (lc == NULL) {
+        return;
+    }
+
+    total = lc->hits + lc->misses;
+    printf(
+        "[*] lcache: %zu-way, %zu sets, %d byte lines\n"
+        "[*] lcache: hits=%zu misses=%zu evictions=%zu",
+        lc->n_ways, lc->n_sets, LCACHE_LINE_SIZE,
+        lc->hits, lc->misses, lc->evictions
+    );
+
+    if (total > 0) {
+        printf(" hit rate=%zu.%02zu%%", (lc->hits * 100) / total,
+            ((lc->hits * 10000) / total) % 100);
+    }
+
+    printf("\n");
+}
@@ -37,14 +37,6 @@ static void
 microsd_write_block(struct spi_block *block, off_t offset)
 {
     balloon_write(&sd_data, offset, block->shift_reg, block->length);
-    for (uint8_t i = 0; i < block->length; ++i) {
-        if (i > 0 && i % 4 == 0) {
-            printf("\n");
-        }
-        printf("%02X ", block->shift_reg[i] & 0xFF);
-    }
-
-    printf("\n");
 }
 
 static void
@@ -55,7 +47,7 @@ microsd_evict(struct spi_slave *slave)
     block = TAILQ_FIRST(&slave->blockq);
     while (block != NULL) {
         TAILQ_REMOVE(&slave->blockq, block, link);
-        free(block);
+        spi_block_free(slave, block);
         block = TAILQ_FIRST(&slave->blockq);
     }
 }
@@ -65,7 +57,6 @@ microsd_flush(struct spi_slave *slave, off_t offset)
 {
     struct spi_block *block;
 
-    printf("begin microsd spi flush\n");
     block = TAILQ_FIRST(&slave->blockq);
 
     if (!microsd_is_inserted()) {
@@ -77,12 +68,29 @@ microsd_flush(struct spi_slave *slave, off_t offset)
             microsd_write_block(block, offset);
         }
 
+        offset += block->length;
         TAILQ_REMOVE(&slave->blockq, block, link);
-        free(block);
+        spi_block_free(slave, block);
         block = TAILQ_FIRST(&slave->blockq);
     }
 }
 
+static void
+microsd_bulk(struct spi_slave *slave, const void *buf, size_t n, off_t offset)
+{
+    ssize_t count;
+
+    if (!microsd_is_inserted()) {
+        trace_error("bulk write to empty microsd port, dropping...\n");
+        return;
+    }
+
+    count = balloon_write(&sd_data, offset, buf, n);
+    if (count < 0) {
+        trace_error("microsd bulk write failure\n");
+    }
+}
+
 static void
 microsd_recv(struct spi_slave *slave, struct spi_prpd *prpd)
 {
@@ -231,5 +239,6 @@ struct spi_slave microsd_slave = {
     .id = SPI_MICROSD,
     .recv = microsd_recv,
     .flush = microsd_flush,
-    .evict = microsd_evict
+    .evict = microsd_evict,
+    .bulk = microsd_bulk
 };
@@ -10,6 +10,7 @@
 #include "emul/defs.h"
 #include "emul/soc.h"
 #include "emul/cpu.h"
+#include "emul/lcache.h"
 #include "emul/busctl.h"
 #include "emul/microsd.h"
 #include "emul/memctl.h"
@@ -49,6 +50,7 @@ soc_spi_handle(struct spi_ctl *ctl)
         return -1;
     }
 
+    ctl->ctlstat &= ~SPICTL_ERR;
     ctl->ctlstat |= SPICTL_BUSY;
     if (prpd.write) {
         retval = spi_write(&prpd);
@@ -58,7 +60,40 @@ soc_spi_handle(struct spi_ctl *ctl)
 
     ctl->ctlstat &= ~SPICTL_BUSY;
     ctl->prpd = 0;
-    return (retval < 0) ? -1 : 0;
+
+    if (retval < 0) {
+        ctl->ctlstat |= SPICTL_ERR;
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Handle a doorbell write to the SPI descriptor ring
+ *
+ * @ctl: SPI ctl registers
+ */
+static int
+soc_spi_ring_handle(struct spi_ctl *ctl)
+{
+    int retval;
+
+    if (ctl == NULL) {
+        return -1;
+    }
+
+    ctl->ctlstat &= ~SPICTL_ERR;
+    ctl->ctlstat |= SPICTL_BUSY;
+    retval = spi_ring_process(&ctl->ring);
+    ctl->ctlstat &= ~SPICTL_BUSY;
+
+    if (retval < 0) {
+        ctl->ctlstat |= SPICTL_ERR;
+        return -1;
+    }
+
+    return 0;
 }
 
 static ssize_t
@@ -83,6 +118,17 @@ ram_read(struct bus_peer *peer, uintptr_t addr, void *buf, size_t n)
         return -1;
     }
 
+    /* Go through the local cache if CE is asserted */
+    if (ISSET(cs_regs->memctl, CS_MEMCTL_CE)) {
+        return lcache_read(
+            &soc->cpu.cache,
+            &soc->ram,
+            bus_peer_mmio(MAIN_MEMORY_START, addr),
+            buf,
+            n
+        );
+    }
+
     return balloon_read(
         &soc->ram,
         bus_peer_mmio(MAIN_MEMORY_START, addr),
@@ -113,6 +159,17 @@ ram_write(struct bus_peer *peer, uintptr_t addr, const void *buf, size_t n)
         return -1;
     }
 
+    /* Go through the local cache if CE is asserted */
+    if (ISSET(cs_regs->memctl, CS_MEMCTL_CE)) {
+        return lcache_write(
+            &soc->cpu.cache,
+            &soc->ram,
+            bus_peer_mmio(MAIN_MEMORY_START, addr),
+            buf,
+            n
+        );
+    }
+
     return balloon_write(
         &soc->ram,
         bus_peer_mmio(MAIN_MEMORY_START, addr),
@@ -126,15 +183,23 @@ chipset_read(struct bus_peer *peer, uintptr_t addr, void *buf, size_t n)
 {
     struct soc_desc *soc;
     struct chipset_regs *cs_regs;
+    uintptr_t off;
+    char *src;
 
     if (peer == NULL || buf == NULL) {
         errno = -EINVAL;
         return -1;
     }
 
+    off = bus_peer_mmio(CHIPSET_REGS_START, addr);
+    if (off >= sizeof(*cs_regs)) {
+        memset(buf, 0, n);
+        return n;
+    }
+
     /* Truncate if needed */
-    if (n >= sizeof(*cs_regs)) {
-        n = sizeof(*cs_regs);
+    if ((off + n) >= sizeof(*cs_regs)) {
+        n = sizeof(*cs_regs) - off;
     }
 
     if ((soc = peer->data) == NULL) {
@@ -143,7 +208,8 @@ chipset_read(struct bus_peer *peer, uintptr_t addr, void *buf, size_t n)
     }
 
     cs_regs = &soc->cs_regs;
-    memcpy(buf, cs_regs, n);
+    src = (char *)cs_regs;
+    memcpy(buf, &src[off], n);
     return n;
 }
 
@@ -153,7 +219,9 @@ chipset_write(struct bus_peer *peer, uintptr_t addr, const void *buf, size_t n)
     struct soc_desc *soc;
     struct chipset_regs *cs_regs;
     struct spi_ctl spi_ctl;
-    uint8_t memctl;
+    uintptr_t off;
+    uint16_t ring_tail;
+    uint8_t memctl, ce_old, ce_new;
     char *dest;
     int error = 0;
 
@@ -162,9 +230,14 @@ chipset_write(struct bus_peer *peer, uintptr_t addr, const void *buf, size_t n)
         return -1;
     }
 
+    off = bus_peer_mmio(CHIPSET_REGS_START, addr);
+    if (off >= sizeof(*cs_regs)) {
+        return n;
+    }
+
     /* Truncate if needed */
-    if (n >= sizeof(*cs_regs)) {
-        n = sizeof(*cs_regs);
+    if ((off + n) >= sizeof(*cs_regs)) {
+        n = sizeof(*cs_regs) - off;
     }
 
     if ((soc = peer->data) == NULL) {
@@ -175,12 +248,9 @@ chipset_write(struct bus_peer *peer, uintptr_t addr, const void *buf, size_t n)
     cs_regs = &soc->cs_regs;
     memctl = cs_regs->memctl;
     spi_ctl = cs_regs->spi_ctl;
+    ring_tail = spi_ctl.ring.tail;
     dest = (char *)cs_regs;
-    memcpy(
-        &dest[bus_peer_mmio(CHIPSET_REGS_START, addr)],
-        buf,
-        n
-    );
+    memcpy(&dest[off], buf, n);
 
     /*
      * If the new memctl value does not have the CG bit set,
@@ -192,6 +262,25 @@ chipset_write(struct bus_peer *peer, uintptr_t addr, const void *buf, size_t n)
             cs_regs->memctl |= CS_MEMCTL_CG;
     }
 
+    /*
+     * CE may only be asserted once CG is, otherwise there is
+     * no external RAM to cache. Asserting it turns the local
+     * cache from cache-as-RAM into a cache of external RAM,
+     * de-asserting it writes back every dirty line.
+     */
+    if (!ISSET(cs_regs->memctl, CS_MEMCTL_CG)) {
+        cs_regs->memctl &= ~CS_MEMCTL_CE;
+    }
+
+    ce_old = ISSET(memctl, CS_MEMCTL_CE);
+    ce_new = ISSET(cs_regs->memctl, CS_MEMCTL_CE);
+    if (ce_new && !ce_old) {
+        lcache_enable(&soc->cpu.cache);
+    } else if (!ce_new && ce_old) {
+        if (lcache_disable(&soc->cpu.cache, &soc->ram) < 0)
+            return -1;
+    }
+
     /* Is there a new SPI transaction? */
     if (spi_ctl.prpd == 0) {
         spi_ctl = cs_regs->spi_ctl;
@@ -202,11 +291,17 @@ chipset_write(struct bus_peer *peer, uintptr_t addr, const void *buf, size_t n)
             return -1;
     }
 
+    /* Has the descriptor ring doorbell been rung? */
+    if (cs_regs->spi_ctl.ring.tail != ring_tail) {
+        if (soc_spi_ring_handle(&cs_regs->spi_ctl) < 0)
+            return -1;
+    }
+
     return n;
 }
 
 int
-soc_power_up(struct soc_desc *soc, size_t memcap)
+soc_power_up(struct soc_desc *soc, size_t memcap, size_t n_ways)
 {
     if (soc == NULL) {
         errno = -EINVAL;
@@ -230,7 +325,7 @@ soc_power_up(struct soc_desc *soc, size_t memcap)
         return -1;
     }
 
-    if (cpu_power_up(&soc->cpu) < 0) {
+    if (cpu_power_up(&soc->cpu, n_ways) < 0) {
         balloon_destroy(&soc->ram);
         return -1;
     }
@@ -6,11 +6,19 @@
 #include <stdint.h>
 #include <errno.h>
 #include <stddef.h>
-#include <stdlib.h>
 #include "emul/spictl.h"
 #include "emul/defs.h"
 #include "emul/memctl.h"
 
+/* Number of ring PRPDs fetched per bus read */
+#define SPI_RING_BATCH 16
+
+/* Staging buffer for bulk transfers */
+static uint8_t bulk_buf[UINT16_MAX];
+
+/* Total bytes moved over the bus */
+static size_t xfer_bytes = 0;
+
 /* List of valid SPI devices */
 static struct spi_slave spi_bus[] = {
     [SPI_MICROSD] =
@@ -22,6 +30,9 @@ static struct spi_slave spi_bus[] = {
     }
 };
 
+/* Block pools of the registered devices, by device ID */
+static struct spi_block spi_pool[NELEM(spi_bus)][SPI_POOL_BLOCKS];
+
 int
 spi_register_device(spi_id_t id, struct spi_slave *device)
 {
@@ -46,17 +57,52 @@ spi_register_device(spi_id_t id, struct spi_slave *device)
     slvp->recv  = device->recv;
     slvp->flush = device->flush;
     slvp->evict = device->evict;
+    slvp->bulk  = device->bulk;
     TAILQ_INIT(&slvp->blockq);
+    TAILQ_INIT(&slvp->freeq);
+
+    for (size_t i = 0; i < SPI_POOL_BLOCKS; ++i) {
+        TAILQ_INSERT_TAIL(&slvp->freeq, &spi_pool[id][i], link);
+    }
+
     return 0;
 }
 
+struct spi_block *
+spi_block_alloc(struct spi_slave *slave)
+{
+    struct spi_block *block;
+
+    if (slave == NULL) {
+        return NULL;
+    }
+
+    if ((block = TAILQ_FIRST(&slave->freeq)) == NULL) {
+        return NULL;
+    }
+
+    TAILQ_REMOVE(&slave->freeq, block, link);
+    block->length = 0;
+    return block;
+}
+
+void
+spi_block_free(struct spi_slave *slave, struct spi_block *block)
+{
+    if (slave == NULL || block == NULL) {
+        return;
+    }
+
+    TAILQ_INSERT_HEAD(&slave->freeq, block, link);
+}
+
 int
 spi_write(struct spi_prpd *prpd)
 {
-    struct spi_block *block = NULL;
+    struct spi_block *block;
     struct spi_slave *slvp;
-    uint16_t bytes_left, delta;
-    uint8_t id;
+    uint16_t bytes_left, delta, flush_off;
+    uint8_t id, len;
     ssize_t count = 0;
 
     id = prpd->chipsel;
@@ -65,17 +111,44 @@ spi_write(struct spi_prpd *prpd)
         return -1;
     }
 
-    bytes_left = prpd->length;
+    if (prpd->length == 0) {
+        return 0;
+    }
+
     slvp = &spi_bus[id];
 
+    /*
+     * If the device can take the whole payload at once, pull
+     * it in with a single bus read and skip the shift register
+     * blocks entirely. A short read would send whatever the
+     * buffer held before, fail the descriptor instead.
+     */
+    if (slvp->bulk != NULL) {
+        count = mem_read(prpd->buffer, bulk_buf, prpd->length);
+        if (count < 0 || (size_t)count < prpd->length) {
+            errno = -EACCES;
+            return -1;
+        }
+
+        slvp->bulk(slvp, bulk_buf, prpd->length, prpd->offset);
+        xfer_bytes += prpd->length;
+        return 0;
+    }
+
+    bytes_left = prpd->length;
+    flush_off = 0;
+
     while (bytes_left > 0) {
         /*
          * Compute the delta / offset of how far we are into
-         * the block and allocate a buffer if needed.
+         * the buffer and take a block from the pool, flushing
+         * what we have so far if it ran dry.
          */
         delta = prpd->length - bytes_left;
-        if (block == NULL) {
-            block = malloc(sizeof(*block));
+        if ((block = spi_block_alloc(slvp)) == NULL) {
+            slvp->flush(slvp, prpd->offset + flush_off);
+            flush_off = delta;
+            block = spi_block_alloc(slvp);
         }
 
         if (block == NULL) {
@@ -84,52 +157,28 @@ spi_write(struct spi_prpd *prpd)
             return -1;
         }
 
-        block->length = 0;
-
-        /* Can we read whole chunks? */
-        if (bytes_left >= SPI_BLOCK_SIZE) {
-            count = mem_read(
-                prpd->buffer + delta,
-                block->shift_reg,
-                SPI_BLOCK_SIZE
-            );
-
-            if (count < 0) {
-                slvp->evict(slvp);
-                free(block);
-                errno = -EACCES;
-                return -1;
-            }
-
-            bytes_left -= SPI_BLOCK_SIZE;
-            block->length = SPI_BLOCK_SIZE;
-
-            TAILQ_INSERT_TAIL(&slvp->blockq, block, link);
-            block = NULL;
-            continue;
-        }
-
+        len = (bytes_left >= SPI_BLOCK_SIZE) ? SPI_BLOCK_SIZE : bytes_left;
         count = mem_read(
             prpd->buffer + delta,
             block->shift_reg,
-            bytes_left
+            len
         );
 
-        if (count < 0) {
+        if (count < 0 || (size_t)count < len) {
+            spi_block_free(slvp, block);
             slvp->evict(slvp);
-            free(block);
             errno = -EACCES;
             return -1;
         }
 
-        block->length += bytes_left;
+        block->length = len;
+        bytes_left -= len;
         TAILQ_INSERT_TAIL(&slvp->blockq, block, link);
-        block = NULL;
-        break;
     }
 
     /* Flush the device */
-    slvp->flush(slvp, prpd->offset);
+    slvp->flush(slvp, prpd->offset + flush_off);
+    xfer_bytes += prpd->length;
     return 0;
 }
 
@@ -147,5 +196,76 @@ spi_read(struct spi_prpd *prpd)
 
     slvp = &spi_bus[id];
     slvp->recv(slvp, prpd);
+    xfer_bytes += prpd->length;
     return 0;
 }
+
+int
+spi_ring_process(struct spi_ring *ring)
+{
+    struct spi_prpd batch[SPI_RING_BATCH];
+    uint16_t n, avail;
+    ssize_t count;
+    int error;
+
+    if (ring == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (ring->size == 0 || ring->base == 0) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (ring->head >= ring->size || ring->tail >= ring->size) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    while (ring->head != ring->tail) {
+        /*
+         * Fetch as many contiguous descriptors as we can in a
+         * single bus read, stopping short of the ring wrap.
+         */
+        if (ring->tail > ring->head) {
+            avail = ring->tail - ring->head;
+        } else {
+            avail = ring->size - ring->head;
+        }
+
+        n = (avail > SPI_RING_BATCH) ? SPI_RING_BATCH : avail;
+        count = mem_read(
+            ring->base + (ring->head * sizeof(batch[0])),
+            batch,
+            n * sizeof(batch[0])
+        );
+
+        if (count < 0) {
+            errno = -EACCES;
+            return -1;
+        }
+
+        for (uint16_t i = 0; i < n; ++i) {
+            if (batch[i].write) {
+                error = spi_write(&batch[i]);
+            } else {
+                error = spi_read(&batch[i]);
+            }
+
+            if (error < 0) {
+                return -1;
+            }
+
+            ring->head = (ring->head + 1) % ring->size;
+        }
+    }
+
+    return 0;
+}
+
+size_t
+spi_xfer_count(void)
+{
+    return xfer_bytes;
+}
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include "emul/symmap.h"
+
+/*
+ * Represents a routine in the profile
+ *
+ * @samples: Samples taken
+ * @idx:     Index of symbol
+ */
+struct symmap_hot {
+    uint64_t samples;
+    uint32_t idx;
+};
+
+/*
+ * Compare two routines by samples taken, most first
+ */
+static int
+symmap_hot_cmp(const void *a, const void *b)
+{
+    const struct symmap_hot *ha = a, *hb = b;
+
+    if (ha->samples != hb->samples) {
+        return (ha->samples > hb->samples) ? -1 : 1;
+    }
+
+    return (ha->idx < hb->idx) ? -1 : (ha->idx > hb->idx);
+}
+
+int
+symmap_init(struct symmap *sm, const void *buf, size_t len)
+{
+    const struct map_hdr *hdr = buf;
+    size_t syms_size;
+
+    if (sm == NULL || buf == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    memset(sm, 0, sizeof(*sm));
+    if (len < sizeof(*hdr)) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (memcmp(hdr->magic, MAP_MAGIC, sizeof(hdr->magic)) != 0) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (hdr->version != MAP_VERSION) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    syms_size = (size_t)hdr->sym_count * sizeof(struct map_sym);
+    if (syms_size > len - sizeof(*hdr)) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if (hdr->str_size > len - sizeof(*hdr) - syms_size) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    sm->base = (void *)buf;
+    sm->size = len;
+    sm->syms = (const void *)((const uint8_t *)buf + sizeof(*hdr));
+    sm->sym_count = hdr->sym_count;
+    sm->strtab = (const char *)sm->syms + syms_size;
+    sm->str_size = hdr->str_size;
+
+    /* Names must stay within the string table */
+    for (uint32_t i = 0; i < sm->sym_count; ++i) {
+        if (sm->syms[i].name >= sm->str_size) {
+            errno = -EINVAL;
+            return -1;
+        }
+    }
+
+    if (sm->str_size > 0 && sm->strtab[sm->str_size - 1] != '\0') {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    sm->samples = calloc(sm->sym_count + 1, sizeof(*sm->samples));
+    if (sm->samples == NULL) {
+        errno = -ENOMEM;
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+symmap_open(struct symmap *sm, const char *path)
+{
+    struct stat st;
+    void *base;
+    int fd;
+
+    if (sm == NULL || path == NULL) {
+        errno = -EINVAL;
+        return -1;
+    }
+
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return -1;
+    }
+
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        close(fd);
+        errno = -EINVAL;
+        return -1;
+    }
+
+    base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    if (symmap_init(sm, base, st.st_size) < 0) {
+        munmap(base, st.st_size);
+        return -1;
+    }
+
+    sm->mapped = true;
+    return 0;
+}
+
+const struct map_sym *
+symmap_lookup(struct symmap *sm, uint64_t addr)
+{
+    const struct map_sym *sym;
+    uint32_t lo, hi, mid;
+
+    if (sm == NULL || sm->sym_count == 0) {
+        return NULL;
+    }
+
+    /* Find the first symbol past the address */
+    lo = 0;
+    hi = sm->sym_count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (sm->syms[mid].addr <= addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo == 0) {
+        return NULL;
+    }
+
+    /* Of several symbols at one address, use the first */
+    sym = &sm->syms[lo - 1];
+    while (sym > sm->syms && sym[-1].addr == sym->addr) {
+        --sym;
+    }
+
+    if (addr - sym->addr >= sym->size) {
+        return NULL;
+    }
+
+    return sym;
+}
+
+const char *
+symmap_name(struct symmap *sm, const struct map_sym *sym)
+{
+    if (sm == NULL || sym == NULL) {
+        return NULL;
+    }
+
+    return &sm->strtab[sym->name];
+}
+
+void
+symmap_print(struct symmap *sm, uint64_t addr)
+{
+    const struct map_sym *sym;
+
+    if ((sym = symmap_lookup(sm, addr)) == NULL) {
+        printf("0x%016zX", (size_t)addr);
+        return;
+    }
+
+    printf("%s+0x%zX", symmap_name(sm, sym), (size_t)(addr - sym->addr));
+}
+
+void
+symmap_sample(struct symmap *sm, uint64_t addr)
+{
+    const struct map_sym *sym;
+
+    if (sm == NULL) {
+        return;
+    }
+
+    if ((sym = symmap_lookup(sm, addr)) == NULL) {
+        ++sm->unknown;
+        return;
+    }
+
+    ++sm->samples[sym - sm->syms];
+}
+
+void
+symmap_report(struct symmap *sm)
+{
+    struct symmap_hot *hot;
+    uint64_t total;
+    uint32_t count = 0;
+
+    if (sm == NULL) {
+        return;
+    }
+
+    total = sm->unknown;
+    for (uint32_t i = 0; i < sm->sym_count; ++i) {
+        total += sm->samples[i];
+    }
+
+    printf("[*] profile: %zu samples, %zu outside any routine\n",
+        (size_t)total, (size_t)sm->unknown);
+
+    if (total == 0) {
+        return;
+    }
+
+    if ((hot = malloc((sm->sym_count + 1) * sizeof(*hot))) == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < sm->sym_count; ++i) {
+        if (sm->samples[i] > 0) {
+            hot[count].samples = sm->samples[i];
+            hot[count++].idx = i;
+        }
+    }
+
+    qsort(hot, count, sizeof(*hot), symmap_hot_cmp);
+    for (uint32_t i = 0; i < count && i < SYMMAP_TOP_COUNT; ++i) {
+        printf(
+            "[*] profile: %3zu.%02zu%% %10zu  %s\n",
+            (size_t)((hot[i].samples * 100) / total),
+            (size_t)(((hot[i].samples * 10000) / total) % 100),
+            (size_t)hot[i].samples,
+            symmap_name(sm, &sm->syms[hot[i].idx])
+        );
+    }
+
+    free(hot);
+}
+
+void
+symmap_close(struct symmap *sm)
+{
+    if (sm == NULL) {
+        return;
+    }
+
+    if (sm->mapped) {
+        munmap(sm->base, sm->size);
+    }
+
+    free(sm->samples);
+    memset(sm, 0, sizeof(*sm));
+}
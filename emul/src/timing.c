@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include "emul/timing.h"
+#include "emul/busctl.h"
+#include "emul/spictl.h"
+#include "emul/cpu.h"
+
+/* Local cache latencies */
+#define LCACHE_HIT_CYCLES  1
+#define LCACHE_FILL_CYCLES (LCACHE_LINE_SIZE / 8)
+
+/* SPI is clocked out a bit at a time */
+#define SPI_BYTE_CYCLES 8
+
+/*
+ * Estimated execute latency of each opcode, memory
+ * latency is accounted for separately.
+ */
+static const uint8_t opc_cycles[] = {
+    [OPCODE_NOP]   = 1,
+    [OPCODE_IMOV]  = 2,
+    [OPCODE_MOV]   = 1,
+    [OPCODE_IMOVS] = 1,
+    [OPCODE_IADD]  = 1,
+    [OPCODE_ADD]   = 1,
+    [OPCODE_ISUB]  = 1,
+    [OPCODE_SUB]   = 1,
+    [OPCODE_HLT]   = 1,
+    [OPCODE_SRR]   = 3,
+    [OPCODE_SRW]   = 3,
+    [OPCODE_IOR]   = 1,
+    [OPCODE_OR]    = 1,
+    [OPCODE_AND]   = 1,
+    [OPCODE_XOR]   = 1,
+    [OPCODE_LITR]  = 2,
+    [OPCODE_STB]   = 1,
+    [OPCODE_STW]   = 1,
+    [OPCODE_STL]   = 1,
+    [OPCODE_STQ]   = 1,
+    [OPCODE_LDB]   = 1,
+    [OPCODE_LDW]   = 1,
+    [OPCODE_LDL]   = 1,
+    [OPCODE_LDQ]   = 1,
+    [OPCODE_B]     = 2,
+    [OPCODE_BEQ]   = 2,
+    [OPCODE_BNE]   = 2,
+    [OPCODE_BLT]   = 2,
+    [OPCODE_BGE]   = 2,
+    [OPCODE_BLTU]  = 2,
+    [OPCODE_BGEU]  = 2
+};
+
+/* Estimated access latency of each bus peer */
+static const uint8_t peer_cycles[] = {
+    [BUS_PEER_BAD]      = 0,
+    [BUS_PEER_FLASHROM] = 8,
+    [BUS_PEER_LCACHE]   = 1,
+    [BUS_PEER_RAM]      = 20,
+    [BUS_PEER_CHIPSET]  = 4
+};
+
+void
+timing_init(struct cpu_timing *tp)
+{
+    if (tp == NULL) {
+        return;
+    }
+
+    memset(tp, 0, sizeof(*tp));
+    tp->spi_bytes = spi_xfer_count();
+}
+
+void
+timing_inst(struct cpu_timing *tp, uint8_t opcode)
+{
+    size_t spi_bytes;
+
+    if (tp == NULL) {
+        return;
+    }
+
+    if (opcode < NELEM(opc_cycles) && opc_cycles[opcode] != 0) {
+        tp->cycles += opc_cycles[opcode];
+    } else {
+        tp->cycles += 1;
+    }
+
+    /* Account for any SPI transfers this instruction kicked off */
+    spi_bytes = spi_xfer_count();
+    tp->cycles += (spi_bytes - tp->spi_bytes) * SPI_BYTE_CYCLES;
+    tp->spi_bytes = spi_bytes;
+    ++tp->insts;
+}
+
+void
+timing_access(struct cpu_timing *tp, struct lcache *lc, uintptr_t addr)
+{
+    struct bus_peer *peer;
+    size_t hits, misses;
+
+    if (tp == NULL || lc == NULL) {
+        return;
+    }
+
+    if (bus_peer_get(&peer, addr) < 0 || peer == NULL) {
+        return;
+    }
+
+    /*
+     * Cache activity outside of cached RAM accesses comes from
+     * SPI transfers, which are charged per byte instead.
+     */
+    if (peer->type != BUS_PEER_RAM || !lc->enabled) {
+        tp->cycles += peer_cycles[peer->type];
+        tp->lc_hits = lc->hits;
+        tp->lc_misses = lc->misses;
+        return;
+    }
+
+    /*
+     * External RAM is being cached, charge a hit for each line
+     * found and a RAM access plus line fill for each miss.
+     */
+    hits = lc->hits - tp->lc_hits;
+    misses = lc->misses - tp->lc_misses;
+    tp->lc_hits = lc->hits;
+    tp->lc_misses = lc->misses;
+
+    tp->cycles += hits * LCACHE_HIT_CYCLES;
+    tp->cycles += misses * (peer_cycles[BUS_PEER_RAM] + LCACHE_FILL_CYCLES);
+}
+
+void
+timing_report(struct cpu_timing *tp)
+{
+    if (tp == NULL) {
+        return;
+    }
+
+    printf(
+        "[*] timing: %zu instructions in ~%zu cycles",
+        (size_t)tp->insts,
+        (size_t)tp->cycles
+    );
+
+    if (tp->cycles > 0) {
+        printf(" (IPC=%.3f)", (double)tp->insts / tp->cycles);
+    }
+
+    printf("\n");
+}
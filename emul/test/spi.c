@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2026, Ian Moffett.
+ * Provided under the BSD-3 clause.
+ */
+
+/*
+ * SPI controller tests and write throughput harness, run
+ * by 'make check'. The controller is linked on its own
+ * against the flat RAM below, so both the pooled block
+ * path and the bulk path can be driven with a test device.
+ */
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include "emul/spictl.h"
+#include "emul/memctl.h"
+
+/* Size of test RAM */
+#define RAM_SIZE 0x10000
+
+/* Size of test device backing store */
+#define SINK_SIZE 0x20000
+
+/* Transfers made per path when timing */
+#define BENCH_ROUNDS 256
+
+/* Bytes a device takes before its pool runs dry */
+#define POOL_BYTES (SPI_POOL_BLOCKS * SPI_BLOCK_SIZE)
+
+static uint8_t ram[RAM_SIZE];
+static uint8_t sink[SINK_SIZE];
+static size_t flush_count;
+static size_t bulk_count;
+static int failures;
+
+/* Reads running off the end of RAM come up short */
+ssize_t
+mem_read(uintptr_t addr, void *buf, size_t n)
+{
+    if (addr >= RAM_SIZE) {
+        return -1;
+    }
+
+    if (n > RAM_SIZE - addr) {
+        n = RAM_SIZE - addr;
+    }
+
+    memcpy(buf, &ram[addr], n);
+    return n;
+}
+
+ssize_t
+mem_write(uintptr_t addr, const void *buf, size_t n)
+{
+    if (addr > RAM_SIZE || n > RAM_SIZE - addr) {
+        return -1;
+    }
+
+    memcpy(&ram[addr], buf, n);
+    return n;
+}
+
+static void
+test_recv(struct spi_slave *slave, struct spi_prpd *prpd)
+{
+    (void)slave;
+    (void)prpd;
+}
+
+static void
+test_flush(struct spi_slave *slave, off_t off)
+{
+    struct spi_block *block;
+
+    while ((block = TAILQ_FIRST(&slave->blockq)) != NULL) {
+        memcpy(&sink[off], block->shift_reg, block->length);
+        off += block->length;
+        TAILQ_REMOVE(&slave->blockq, block, link);
+        spi_block_free(slave, block);
+    }
+
+    ++flush_count;
+}
+
+static void
+test_evict(struct spi_slave *slave)
+{
+    struct spi_block *block;
+
+    while ((block = TAILQ_FIRST(&slave->blockq)) != NULL) {
+        TAILQ_REMOVE(&slave->blockq, block, link);
+        spi_block_free(slave, block);
+    }
+}
+
+static void
+test_bulk(struct spi_slave *slave, const void *buf, size_t n, off_t off)
+{
+    (void)slave;
+    memcpy(&sink[off], buf, n);
+    ++bulk_count;
+}
+
+/* Test device without a bulk path */
+static struct spi_slave block_dev = {
+    .id = SPI_MICROSD,
+    .recv = test_recv,
+    .flush = test_flush,
+    .evict = test_evict
+};
+
+/* Test device with a bulk path */
+static struct spi_slave bulk_dev = {
+    .id = SPI_MICROSD,
+    .recv = test_recv,
+    .flush = test_flush,
+    .evict = test_evict,
+    .bulk = test_bulk
+};
+
+static void
+check(bool cond, const char *what)
+{
+    if (!cond) {
+        printf("FAIL %s\n", what);
+        ++failures;
+        return;
+    }
+
+    printf("ok %s\n", what);
+}
+
+/*
+ * Write a PRPD to the test device and check that the sink
+ * holds an exact copy of the payload
+ *
+ * @len: Payload length
+ * @off: Device offset
+ */
+static bool
+write_one(uint16_t len, uint16_t off)
+{
+    struct spi_prpd prpd;
+
+    memset(&prpd, 0, sizeof(prpd));
+    prpd.buffer = 0;
+    prpd.length = len;
+    prpd.chipsel = SPI_MICROSD;
+    prpd.write = 1;
+    prpd.offset = off;
+
+    memset(sink, 0, sizeof(sink));
+    if (spi_write(&prpd) < 0) {
+        return false;
+    }
+
+    if (memcmp(&sink[off], ram, len) != 0) {
+        return false;
+    }
+
+    /* Nothing may spill past the payload */
+    return sink[off + len] == 0 && (off == 0 || sink[off - 1] == 0);
+}
+
+/*
+ * Write a PRPD whose buffer runs off the end of RAM, which
+ * must fail without reaching the device
+ */
+static bool
+write_short(void)
+{
+    struct spi_prpd prpd;
+
+    memset(&prpd, 0, sizeof(prpd));
+    prpd.buffer = RAM_SIZE - 0x10;
+    prpd.length = 0x40;
+    prpd.chipsel = SPI_MICROSD;
+    prpd.write = 1;
+
+    flush_count = 0;
+    bulk_count = 0;
+    if (spi_write(&prpd) == 0) {
+        return false;
+    }
+
+    return flush_count == 0 && bulk_count == 0;
+}
+
+/*
+ * Time a number of full-size writes and report the rate
+ *
+ * @what: Name of path being timed
+ */
+static void
+bench(const char *what)
+{
+    struct spi_prpd prpd;
+    struct timespec t0, t1;
+    double secs;
+
+    memset(&prpd, 0, sizeof(prpd));
+    prpd.length = 0xFFF0;
+    prpd.chipsel = SPI_MICROSD;
+    prpd.write = 1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (size_t i = 0; i < BENCH_ROUNDS; ++i) {
+        spi_write(&prpd);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf(
+        "[*] %-6s %d x %u bytes in %.3f ms (%.1f MiB/s)\n",
+        what,
+        BENCH_ROUNDS,
+        prpd.length,
+        secs * 1000.0,
+        (BENCH_ROUNDS * (double)prpd.length) / (secs * 1024 * 1024)
+    );
+}
+
+int
+main(int argc, char **argv)
+{
+    bool do_bench = argc > 1 && strcmp(argv[1], "-b") == 0;
+
+    for (size_t i = 0; i < RAM_SIZE; ++i) {
+        ram[i] = (i * 7 + (i >> 8)) & 0xFF;
+    }
+
+    /* Pooled blocks, the payload fits the pool */
+    if (spi_register_device(SPI_MICROSD, &block_dev) < 0) {
+        printf("FAIL register block device\n");
+        return 1;
+    }
+
+    flush_count = 0;
+    check(write_one(100, 3), "block path, partial last block");
+    check(flush_count == 1, "block path, single flush");
+
+    /* Pooled blocks, the pool runs dry and is flushed early */
+    flush_count = 0;
+    check(write_one(0xFFF3, 0x20), "block path, pool exhausted");
+    check(
+        flush_count == (0xFFF3 + POOL_BYTES - 1) / POOL_BYTES,
+        "block path, early flushes"
+    );
+
+    /* Every block must have made it back to the pool */
+    flush_count = 0;
+    check(write_one(POOL_BYTES, 0), "block path, exactly one pool");
+    check(flush_count == 1, "block path, no early flush");
+    check(write_short(), "block path, short read fails");
+
+    /* Bulk path, no blocks are used */
+    if (spi_register_device(SPI_MICROSD, &bulk_dev) < 0) {
+        printf("FAIL register bulk device\n");
+        return 1;
+    }
+
+    flush_count = 0;
+    bulk_count = 0;
+    check(write_one(0xFFF3, 0x20), "bulk path");
+    check(bulk_count == 1 && flush_count == 0, "bulk path, one call");
+    check(write_short(), "bulk path, short read fails");
+
+    if (do_bench) {
+        spi_register_device(SPI_MICROSD, &block_dev);
+        bench("blocks");
+        spi_register_device(SPI_MICROSD, &bulk_dev);
+        bench("bulk");
+    }
+
+    return failures != 0;
+}